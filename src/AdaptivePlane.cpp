@@ -0,0 +1,69 @@
+#include "AdaptivePlane.hpp"
+
+#include "Rtin.hpp"
+#include "bx/math.h"
+
+namespace worldWp {
+
+AdaptivePlane::AdaptivePlane(
+  const util::PlaneSpecs& ms,
+  const float* heights,
+  float max_error,
+  const uint32_t abgr
+)
+	: AdaptivePlane{ ms, heights, Rtin{ms, heights}.triangles(max_error), abgr } { }
+
+AdaptivePlane::AdaptivePlane(
+  const util::PlaneSpecs& ms,
+  const float* heights,
+  const std::vector<uint32_t>& tris,
+  const uint32_t abgr
+)
+	//three vertices per triangle, each triangle twice for both sides.
+	: Model{ int(tris.size()), int(tris.size())*2, 0x0000000000000000 },
+	  ms{ ms },
+	  tri_count{ int(tris.size())/3 } {
+	for(int i{0}; i != int(tris.size()); ++i) {
+		int x{ int(tris[i]) / ms.z_dim },
+		    z{ int(tris[i]) % ms.z_dim };
+		verts[i] = { float(x*ms.res-(ms.x_dim-1)*ms.res/2.0),
+		             heights[tris[i]],
+		             float(z*ms.res-(ms.z_dim-1)*ms.res/2.0),
+		             0, 0, 0,
+		             abgr };
+	}
+
+	for(int t{0}; t != tri_count; ++t) {
+		util::PosNormalColorVertex *v{ &verts[t*3] };
+		bx::Vec3 normal{ util::triangle_normal(
+			{v[0].pos[0], v[0].pos[1], v[0].pos[2]},
+			{v[1].pos[0], v[1].pos[1], v[1].pos[2]},
+			{v[2].pos[0], v[2].pos[1], v[2].pos[2]} ) };
+		//orientation of Rtin-triangles alternates, normals should point up.
+		if (normal.y < 0)
+			normal = bx::mul(normal, -1.0f);
+		for(int i{0}; i != 3; ++i) {
+			v[i].normal[0] = normal.x;
+			v[i].normal[1] = normal.y;
+			v[i].normal[2] = normal.z;
+		}
+
+		indzs[t*6   ] = t*3;
+		indzs[t*6+ 1] = t*3+1;
+		indzs[t*6+ 2] = t*3+2;
+
+		indzs[t*6+ 3] = t*3+1;
+		indzs[t*6+ 4] = t*3;
+		indzs[t*6+ 5] = t*3+2;
+	}
+}
+
+int AdaptivePlane::get_triangle_count() const {
+	return tri_count;
+}
+
+float AdaptivePlane::get_reduction() const {
+	return float((ms.x_dim-1)*(ms.z_dim-1)*2) / tri_count;
+}
+
+};
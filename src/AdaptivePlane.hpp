@@ -0,0 +1,40 @@
+#ifndef ADAPTIVE_PLANE_H_
+#define ADAPTIVE_PLANE_H_
+
+#include "Util.hpp"
+#include "Model.tpp"
+
+#include <vector>
+
+namespace worldWp {
+
+/**
+ * Static terrain with as few triangles as possible while staying within
+ * max_error (vertically) of the height grid, see Rtin.
+ * Each triangle has its own three vertices so it can carry a flat normal.
+ */
+class AdaptivePlane : public Model<uint32_t> {
+public:
+	AdaptivePlane(
+	  const util::PlaneSpecs& ms,
+	  const float* heights,
+	  float max_error,
+	  const uint32_t abgr );
+
+	int get_triangle_count() const;
+	//triangles of a full Plane per triangle of this mesh.
+	float get_reduction() const;
+private:
+	AdaptivePlane(
+	  const util::PlaneSpecs& ms,
+	  const float* heights,
+	  const std::vector<uint32_t>& tris,
+	  const uint32_t abgr );
+
+	util::PlaneSpecs ms;
+	int tri_count;
+};
+
+};
+
+#endif
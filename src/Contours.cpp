@@ -0,0 +1,125 @@
+#include "Contours.hpp"
+
+#include "bgfx/bgfx.h"
+
+#include <algorithm>
+#include <cmath>
+
+//quad-rows per band, bands are extracted in parallel.
+const int band_rows{16};
+
+//lift lines above the surface so they dont z-fight with it.
+const float line_offset{.05};
+
+namespace worldWp {
+
+Contours::Contours(const util::PlaneSpecs& ms, float interval, const uint32_t abgr)
+	: Model{ 0, 0, BGFX_STATE_PT_LINES },
+	  ms{ ms },
+	  interval{ interval },
+	  abgr{ abgr },
+	  band_lines( (ms.x_dim-1 + band_rows-1) / band_rows ),
+	  updated_bands{0} { }
+
+void Contours::update(const float* heights) {
+	bool first{ this->heights.empty() };
+	std::vector<bool> changed(band_lines.size());
+	updated_bands = 0;
+	for(size_t b{0}; b != band_lines.size(); ++b) {
+		//band uses its rows plus the first row of the next band.
+		int start{ int(b)*band_rows*ms.z_dim },
+		    end{ std::min((int(b)+1)*band_rows+1, ms.x_dim)*ms.z_dim };
+		changed[b] = first || !std::equal(heights+start, heights+end,
+		                                  this->heights.begin()+start);
+		updated_bands += changed[b];
+	}
+	this->heights.assign(heights, heights + ms.x_dim*ms.z_dim);
+
+	util::parallel_for(band_lines.size(), [&](int begin, int end) {
+		for(int b{begin}; b != end; ++b)
+			if (changed[b])
+				extract_band(b, heights);
+	});
+
+	int vert_count{0};
+	for(const std::vector<float>& lines : band_lines)
+		vert_count += lines.size()/3;
+	resize(vert_count, vert_count);
+
+	int indx{0};
+	for(const std::vector<float>& lines : band_lines)
+		for(size_t i{0}; i != lines.size(); i += 3, ++indx) {
+			verts[indx] = {lines[i], lines[i+1], lines[i+2], 0,0,0, abgr};
+			indzs[indx] = indx;
+		}
+}
+
+void Contours::extract_band(int band, const float* heights) {
+	std::vector<float>& lines{ band_lines[band] };
+	lines.clear();
+
+	auto add_point{ [&](float x0, float z0, float h0, float x1, float z1, float h1, float level) {
+		float t{ (level-h0)/(h1-h0) };
+		lines.push_back(x0 + (x1-x0)*t);
+		lines.push_back(level + line_offset);
+		lines.push_back(z0 + (z1-z0)*t);
+	}};
+
+	//emit segment of triangle a b c (grid-coords + height) at level.
+	auto add_triangle{ [&](const float a[3], const float b[3], const float c[3], float level) {
+		const float *tri[3]{a, b, c};
+		int above{ (a[2] >= level) | (b[2] >= level) << 1 | (c[2] >= level) << 2 };
+		if (above == 0 || above == 7)
+			return;
+		//the vertex alone on its side of level.
+		int lone{ (above == 1 || above == 6) ? 0 : (above == 2 || above == 5) ? 1 : 2 };
+		const float *l{ tri[lone] },
+		            *o1{ tri[(lone+1)%3] },
+		            *o2{ tri[(lone+2)%3] };
+		add_point(l[0], l[1], l[2], o1[0], o1[1], o1[2], level);
+		add_point(l[0], l[1], l[2], o2[0], o2[1], o2[2], level);
+	}};
+
+	float x_start{ -(ms.x_dim-1)*ms.res/2.0f },
+	      z_start{ -(ms.z_dim-1)*ms.res/2.0f };
+	for(int i{band*band_rows}; i != std::min((band+1)*band_rows, ms.x_dim-1); ++i) {
+		const float *row0{ heights + i*ms.z_dim },
+		            *row1{ row0 + ms.z_dim };
+		float x0{ x_start + i*ms.res },
+		      x1{ x0 + ms.res };
+		for(int j{0}; j != ms.z_dim-1; ++j) {
+			float lo{ std::min({row0[j], row0[j+1], row1[j], row1[j+1]}) },
+			      hi{ std::max({row0[j], row0[j+1], row1[j], row1[j+1]}) };
+			int first_level{ int(std::ceil(lo/interval)) },
+			    last_level{ int(std::floor(hi/interval)) };
+			//most quads dont cross any level.
+			if (first_level > last_level)
+				continue;
+
+			float z0{ z_start + j*ms.res },
+			      z1{ z0 + ms.res };
+			//same corners as v1..v4 in Plane.
+			float v1[3]{x0, z0, row0[j]},
+			      v2[3]{x0, z1, row0[j+1]},
+			      v3[3]{x1, z0, row1[j]},
+			      v4[3]{x1, z1, row1[j+1]};
+			for(int l{first_level}; l <= last_level; ++l) {
+				add_triangle(v1, v2, v3, l*interval);
+				add_triangle(v2, v4, v3, l*interval);
+			}
+		}
+	}
+}
+
+int Contours::get_segment_count() const {
+	int count{0};
+	for(const std::vector<float>& lines : band_lines)
+		count += lines.size()/6;
+	return count;
+}
+
+int Contours::get_updated_band_count() const {
+	return updated_bands;
+}
+
+};
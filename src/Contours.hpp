@@ -0,0 +1,44 @@
+#ifndef CONTOURS_H_
+#define CONTOURS_H_
+
+#include "Util.hpp"
+#include "Model.tpp"
+
+#include <vector>
+
+namespace worldWp {
+
+/**
+ * Isolines of a height grid at every multiple of interval, as line list.
+ * Each quad is split into the same two triangles Plane renders, so the lines
+ * lie exactly on the surface and saddles are unambiguous.
+ */
+class Contours : public Model<uint32_t> {
+public:
+	Contours(const util::PlaneSpecs& ms, float interval, const uint32_t abgr);
+
+	/**
+	 * Extract isolines from heights (x_dim*z_dim values).
+	 * Only bands of rows whose heights changed since the last call are redone.
+	 * Buffer handles have to be recreated afterwards.
+	 */
+	void update(const float* heights);
+	int get_segment_count() const;
+	//bands of rows extracted again by the last update.
+	int get_updated_band_count() const;
+private:
+	util::PlaneSpecs ms;
+	float interval;
+	uint32_t abgr;
+	//heights of the last update, to find unchanged bands.
+	std::vector<float> heights;
+	//line vertex positions (x, y, z) found in each band of rows.
+	std::vector<std::vector<float>> band_lines;
+	int updated_bands;
+
+	void extract_band(int band, const float* heights);
+};
+
+};
+
+#endif
@@ -0,0 +1,144 @@
+#include "Erosion.hpp"
+
+#include <algorithm>
+
+//rows per block, blocks are handed to threads and processed row by row so
+//the three rows of the stencil stay in cache.
+const int block_rows{32};
+
+//height of the border, no water or material flows onto it.
+const float border_height{1e30};
+
+namespace worldWp {
+
+Erosion::Erosion(const util::PlaneSpecs& ms, const float* heights, const Params& p, int iterations)
+	: ms{ ms },
+	  p{ p },
+	  iterations_left{ iterations },
+	  stride{ ms.z_dim+2 },
+	  h((ms.x_dim+2)*stride, border_height),
+	  w((ms.x_dim+2)*stride, 0),
+	  s((ms.x_dim+2)*stride, 0),
+	  h_next((ms.x_dim+2)*stride, border_height),
+	  w_next((ms.x_dim+2)*stride, 0),
+	  s_next((ms.x_dim+2)*stride, 0),
+	  sed_ratio((ms.x_dim+2)*stride, 0) {
+	for(std::vector<float>& f : flow)
+		f.assign((ms.x_dim+2)*stride, 0);
+	for(int i{0}; i != ms.x_dim; ++i)
+		std::copy(heights + i*ms.z_dim, heights + (i+1)*ms.z_dim,
+		          h.begin() + (i+1)*stride + 1);
+}
+
+bool Erosion::step(int budget) {
+	if (done())
+		return true;
+	for(; budget > 0 && iterations_left > 0; --budget, --iterations_left)
+		iterate();
+
+	//drop what the water still carries.
+	if (done())
+		for_each_row([&](int c_begin, int c_end) {
+			for(int c{c_begin}; c != c_end; ++c)
+				h[c] += s[c];
+		});
+	return done();
+}
+
+bool Erosion::done() const {
+	return iterations_left <= 0;
+}
+
+std::vector<float> Erosion::get_heights() const {
+	std::vector<float> out(ms.x_dim*ms.z_dim);
+	for(int i{0}; i != ms.x_dim; ++i)
+		std::copy(h.begin() + (i+1)*stride + 1, h.begin() + (i+1)*stride + 1 + ms.z_dim,
+		          out.begin() + i*ms.z_dim);
+	return out;
+}
+
+void Erosion::for_each_row(const std::function<void(int c_begin, int c_end)>& fn) {
+	int blocks{ (ms.x_dim + block_rows-1) / block_rows };
+	util::parallel_for(blocks, [&](int begin, int end) {
+		for(int i{begin*block_rows}; i != std::min(end*block_rows, ms.x_dim); ++i)
+			fn((i+1)*stride + 1, (i+1)*stride + 1 + ms.z_dim);
+	});
+}
+
+void Erosion::iterate() {
+	const int st{stride};
+	float *f0{ flow[0].data() }, *f1{ flow[1].data() },
+	      *f2{ flow[2].data() }, *f3{ flow[3].data() };
+
+	//water flows towards lower water-surfaces, limited by the water present.
+	for_each_row([&](int c_begin, int c_end) {
+		for(int c{c_begin}; c != c_end; ++c) {
+			float water{ w[c] + p.rain },
+			      surface{ h[c] + w[c] },
+			      d0{ std::max(0.0f, surface - h[c-st] - w[c-st]) },
+			      d1{ std::max(0.0f, surface - h[c+st] - w[c+st]) },
+			      d2{ std::max(0.0f, surface - h[c-1] - w[c-1]) },
+			      d3{ std::max(0.0f, surface - h[c+1] - w[c+1]) },
+			      total{ d0+d1+d2+d3 };
+			//a quarter of the total drop levels out a single lower neighbour.
+			float scale{ total > 0 ? std::min(water, total/4)/total : 0 };
+			f0[c] = d0*scale;
+			f1[c] = d1*scale;
+			f2[c] = d2*scale;
+			f3[c] = d3*scale;
+			//dry cells (no rain) carry nothing.
+			sed_ratio[c] = water > 0 ? s[c]/water : 0;
+		}
+	});
+
+	//gather water and sediment, then erode or deposit.
+	for_each_row([&](int c_begin, int c_end) {
+		for(int c{c_begin}; c != c_end; ++c) {
+			float water{ w[c] + p.rain },
+			      out{ f0[c] + f1[c] + f2[c] + f3[c] },
+			      //flows of the neighbours towards this cell.
+			      in{ f1[c-st] + f0[c+st] + f3[c-1] + f2[c+1] },
+			      //sediment moves with the fraction of water that leaves a cell.
+			      sed_in{ sed_ratio[c-st]*f1[c-st] + sed_ratio[c+st]*f0[c+st]
+			            + sed_ratio[c-1]*f3[c-1] + sed_ratio[c+1]*f2[c+1] },
+			      sediment{ s[c] - sed_ratio[c]*out + sed_in },
+			      capacity{ p.capacity*(in+out)/2 },
+			      excess{ sediment - capacity },
+			      //deposit excess sediment, or erode up to capacity.
+			      change{ excess > 0 ? p.deposition*excess : p.erosion*excess };
+			h_next[c] = h[c] + change;
+			w_next[c] = (water - out + in)*(1 - p.evaporation);
+			s_next[c] = sediment - change;
+		}
+	});
+	h.swap(h_next);
+	w.swap(w_next);
+	s.swap(s_next);
+
+	//thermal: material above talus slides to lower neighbours.
+	float talus{ p.talus*ms.res };
+	for_each_row([&](int c_begin, int c_end) {
+		for(int c{c_begin}; c != c_end; ++c) {
+			float e0{ std::max(0.0f, h[c] - h[c-st] - talus) },
+			      e1{ std::max(0.0f, h[c] - h[c+st] - talus) },
+			      e2{ std::max(0.0f, h[c] - h[c-1] - talus) },
+			      e3{ std::max(0.0f, h[c] - h[c+1] - talus) },
+			      total{ e0+e1+e2+e3 },
+			      max_excess{ std::max(std::max(e0, e1), std::max(e2, e3)) },
+			      scale{ total > 0 ? p.thermal_rate*max_excess/2/total : 0 };
+			f0[c] = e0*scale;
+			f1[c] = e1*scale;
+			f2[c] = e2*scale;
+			f3[c] = e3*scale;
+		}
+	});
+
+	for_each_row([&](int c_begin, int c_end) {
+		for(int c{c_begin}; c != c_end; ++c)
+			h_next[c] = h[c] - (f0[c] + f1[c] + f2[c] + f3[c])
+			          + f1[c-st] + f0[c+st] + f3[c-1] + f2[c+1];
+	});
+	h.swap(h_next);
+}
+
+};
@@ -0,0 +1,68 @@
+#ifndef EROSION_H_
+#define EROSION_H_
+
+#include "Util.hpp"
+
+#include <functional>
+#include <vector>
+
+namespace worldWp {
+
+/**
+ * Grid-based hydraulic and thermal erosion of a height grid.
+ * Every pass only writes the cell it computes and reads the results of the
+ * previous pass, so the result doesn't depend on the number of threads.
+ */
+class Erosion {
+public:
+	struct Params {
+		//water added to every cell per iteration.
+		float rain{.01};
+		//fraction of water that evaporates per iteration.
+		float evaporation{.02};
+		//sediment a cell can carry per unit of flowing water.
+		float capacity{2};
+		//fraction of missing/excess capacity eroded/deposited per iteration.
+		float erosion{.3},
+		      deposition{.3};
+		//height difference to neighbours above which material slides down,
+		//and fraction of the excess that does.
+		float talus{2},
+		      thermal_rate{.25};
+	};
+
+	Erosion(const util::PlaneSpecs& ms, const float* heights, const Params& p, int iterations);
+
+	/**
+	 * Run at most budget iterations, eg. a few per frame.
+	 * @return true once all iterations are done.
+	 */
+	bool step(int budget);
+	bool done() const;
+	//current heights, x_dim*z_dim values.
+	std::vector<float> get_heights() const;
+private:
+	util::PlaneSpecs ms;
+	Params p;
+	int iterations_left;
+	//all grids have a border of one cell that never changes (no water,
+	//"infinitely" high), so the passes need no bounds-checks.
+	int stride;
+	//terrain, water, sediment, and the next values of each.
+	std::vector<float> h, w, s,
+	                   h_next, w_next, s_next;
+	//sediment per water of each cell.
+	std::vector<float> sed_ratio;
+	//outflow of water (then material) from each cell towards its
+	//neighbours at -x, +x, -z, +z.
+	std::vector<float> flow[4];
+
+	void iterate();
+	//call fn(c_begin, c_end) for the inner cells of each row,
+	//blocks of rows are spread over all cores.
+	void for_each_row(const std::function<void(int c_begin, int c_end)>& fn);
+};
+
+};
+
+#endif
@@ -54,7 +54,18 @@ namespace worldWp {
 Frame::Frame(const util::PlaneSpecs& ms, const uint32_t abgr, float y_start, float height)
 	//pass 0 for PT, normal Triangles.
 	: Model{ vbuf_sz, ibuf_sz, 0x0000000000000000 },
-	  ms{ ms } {
+	  ms{ ms },
+	  abgr{ abgr },
+	  y_start{ y_start },
+	  height{ height } {
+	add_frame(y_start, height, abgr);
+}
+
+bool Frame::can_rebuild() const {
+	return true;
+}
+
+void Frame::rebuild() {
 	add_frame(y_start, height, abgr);
 }
 
@@ -11,8 +11,13 @@ namespace worldWp {
 class Frame : public Model<uint16_t> {
 public:
 	Frame(const util::PlaneSpecs& ms, const uint32_t abgr, float y_start, float height);
+protected:
+	bool can_rebuild() const override;
+	void rebuild() override;
 private:
 	util::PlaneSpecs ms;
+	uint32_t abgr;
+	float y_start, height;
 
 	void add_frame_vertices_2d(
 	  Dimension dim,
@@ -0,0 +1,79 @@
+#include "Grid.hpp"
+
+#include "NoiseTiles.hpp"
+
+namespace worldWp {
+namespace grid {
+
+float* get_raw_noise(
+  const util::PlaneSpecs& ms,
+  const FastNoise& fn,
+  const util::NoiseMods& nm,
+  int tile_octaves
+) {
+	float* ns {new float[ms.x_dim*ms.z_dim]};
+	if (tile_octaves > 0) {
+		NoiseTiles::Sampler sampler{ NoiseTiles::get().get_sampler(fn, tile_octaves) };
+		util::parallel_for(ms.x_dim, [&](int begin, int end) {
+			for(int i{begin}; i != end; ++i) {
+				float* row{ ns + i*ms.z_dim };
+				sampler.sample_row(nm.x_stretch*i*ms.res, 0, nm.z_stretch*ms.res, ms.z_dim, row);
+				for(int j{0}; j != ms.z_dim; ++j)
+					row[j] = nm.post_mod(nm.res_stretch[i*ms.z_dim + j]*row[j]);
+			}
+		});
+		return ns;
+	}
+
+	int indx {0};
+	for(int i {0}; i != ms.x_dim*ms.res; i+=ms.res)
+		for(int j {0}; j != ms.z_dim*ms.res; j+=ms.res, ++indx)
+			ns[indx] = util::get_noise_mdfd(indx, i, j, fn, nm);
+	return ns;
+}
+
+void fill_vertices(
+  util::PosNormalColorVertex *verts,
+  const util::PlaneSpecs& ms,
+  const float* noise,
+  int row_start, int rows,
+  uint32_t abgr
+) {
+	int offset{ rows*ms.z_dim },
+	    indx{ row_start*ms.z_dim },
+	    local_indx{0};
+	for(int i {row_start*ms.res}; i != (row_start+rows)*ms.res; i+=ms.res)
+		for(int j {0}; j != ms.z_dim*ms.res; j+=ms.res, ++indx, ++local_indx)
+			verts[local_indx+offset] =
+			verts[local_indx       ] = { float(i-(ms.x_dim-1)*ms.res/2.0),
+			                             noise[indx],
+			                             float(j-(ms.z_dim-1)*ms.res/2.0),
+			                             0, 0, 0,
+			                             abgr };
+}
+
+void add_normals(
+  util::PosNormalColorVertex *verts,
+  int x_dim, int z_dim,
+  int quad_x0, int quad_z0,
+  int quad_x1, int quad_z1
+) {
+	int offset{ x_dim*z_dim };
+	for(int i{quad_x0}; i != quad_x1; ++i)
+		for(int j{quad_z0}; j != quad_z1; ++j) {
+			int v1{ i*z_dim + j };
+			//"upward-pointing" triangle is provoked by its first vertex.
+			util::add_normal(&verts[v1],
+				(float*) &verts[v1+1],
+				(float*) &verts[v1+z_dim]);
+
+			//"downward-pointing" triangle, provoked by v2 of second copy.
+			int v2{ offset+v1+1 };
+			util::add_normal(&verts[v2],
+				(float*) &verts[v2+z_dim],
+				(float*) &verts[v2+z_dim-1]);
+		}
+}
+
+};
+};
@@ -0,0 +1,92 @@
+#ifndef GRID_H_
+#define GRID_H_
+
+#include "Util.hpp"
+
+#include "FastNoise.h"
+
+namespace worldWp {
+namespace grid {
+
+/**
+ * Fill indzs with the triangles of a x_dim x z_dim grid whose vertices are
+ * stored twice (second copy at x_dim*z_dim), like in Plane.
+ * Indices are local to verts, T may be uint16_t if 2*x_dim*z_dim fits.
+ */
+template<typename T>
+void fill_indzs(T *indzs, int x_dim, int z_dim) {
+	int offset{ x_dim*z_dim },
+	    plane_x_dim{ x_dim-1 },
+	    plane_z_dim{ z_dim-1 };
+	for(int i = 0; i != plane_x_dim; ++i)
+		for(int j = 0; j != plane_z_dim; ++j) {
+			int vert_start_indx {i*z_dim + j};
+
+			//init vertices for triangles.
+			int v1{ vert_start_indx },
+			    v2{ v1+1 },
+			    v3{ vert_start_indx+z_dim },
+			    v4{ v3+1 };
+
+			int tri_start_indx {(i*plane_z_dim + j) * 12};
+			//first Triangle of "square".
+			indzs[tri_start_indx   ] = v3;
+			indzs[tri_start_indx+ 1] = v2;
+			indzs[tri_start_indx+ 2] = v1;
+
+			indzs[tri_start_indx+ 3] = v2;
+			indzs[tri_start_indx+ 4] = v3;
+			indzs[tri_start_indx+ 5] = v1;
+
+			//second Triangle of "square".
+			indzs[tri_start_indx+ 6] = v3+offset;
+			indzs[tri_start_indx+ 7] = v4+offset;
+			indzs[tri_start_indx+ 8] = v2+offset;
+
+			indzs[tri_start_indx+ 9] = v4+offset;
+			indzs[tri_start_indx+10] = v3+offset;
+			indzs[tri_start_indx+11] = v2+offset;
+		}
+}
+
+//number of indices fill_indzs writes.
+inline int indzs_count(int x_dim, int z_dim) {
+	return (x_dim-1)*(z_dim-1)*2*2*3;
+}
+
+/**
+ * Noise of fn modified by nm for all grid-points of ms (index i*z_dim + j),
+ * sampled from the NoiseTiles of fn if tile_octaves > 0.
+ * The caller deletes the array.
+ */
+float* get_raw_noise(
+  const util::PlaneSpecs& ms,
+  const FastNoise& fn,
+  const util::NoiseMods& nm,
+  int tile_octaves );
+
+/**
+ * Write grid-rows [row_start, row_start+rows) of ms into verts, heights from
+ * noise (all grid-points), second copy at rows*z_dim like fill_indzs expects.
+ */
+void fill_vertices(
+  util::PosNormalColorVertex *verts,
+  const util::PlaneSpecs& ms,
+  const float* noise,
+  int row_start, int rows,
+  uint32_t abgr );
+
+/**
+ * Recompute the normals of the quads [quad_x0, quad_x1) x [quad_z0, quad_z1)
+ * of a grid laid out like fill_indzs expects.
+ */
+void add_normals(
+  util::PosNormalColorVertex *verts,
+  int x_dim, int z_dim,
+  int quad_x0, int quad_z0,
+  int quad_x1, int quad_z1 );
+
+};
+};
+
+#endif
@@ -0,0 +1,161 @@
+#include "HeightPublisher.hpp"
+#include "HeightReader.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+uint64_t now_ns() {
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * Follow the frames of name until frame last was seen or timeout_s passed,
+ * print latency and throughput. If check, frames have to match the pattern
+ * of bench.
+ */
+int read_frames(const std::string& name, uint64_t last, int timeout_s, bool check) {
+	worldWp::HeightReader reader{name};
+	if (!reader.is_open())
+		return 1;
+	size_t grid_sz( reader.get_x_dim()*reader.get_z_dim() );
+
+	std::vector<double> latencies;
+	uint64_t seen{0}, torn{0}, corrupt{0}, bytes{0},
+	         first_frame(-1), prev_frame(-1);
+	uint64_t start{ now_ns() }, timeout_ns( timeout_s*1000000000ull );
+	//keeps the reads from being optimized away.
+	volatile float sink{0};
+	//frames may be skipped, last included.
+	while ((prev_frame == uint64_t(-1) || prev_frame < last) && now_ns() - start < timeout_ns) {
+		if (reader.get_published() == 0 || reader.get_published()-1 == prev_frame) {
+			std::this_thread::yield();
+			continue;
+		}
+		uint64_t frame, time_ns;
+		bool consistent{true};
+		bool ok{ reader.read_latest([&](const worldWp::HeightReader::Snapshot& snap) {
+			//touch everything, like a consumer would.
+			float sum{0};
+			for(size_t i{0}; i != grid_sz; ++i)
+				sum += snap.heights[i] + snap.normals[i*3+1];
+			sink = sink + sum;
+			frame = snap.frame;
+			time_ns = snap.time_ns;
+			consistent = !check || (snap.heights[0] == float(snap.frame)
+			                     && snap.heights[grid_sz-1] == float(snap.frame));
+		}) };
+		if (!ok) {
+			++torn;
+			continue;
+		}
+		if (frame == prev_frame)
+			continue;
+		latencies.push_back((now_ns() - time_ns)/1000.0);
+		corrupt += !consistent;
+		bytes += grid_sz*4*sizeof(float);
+		if (seen++ == 0)
+			first_frame = frame;
+		prev_frame = frame;
+	}
+	double secs{ (now_ns() - start)/1e9 };
+
+	std::sort(latencies.begin(), latencies.end());
+	double mean{0};
+	for(double l : latencies)
+		mean += l;
+	mean /= std::max<size_t>(latencies.size(), 1);
+	auto percentile{ [&](double p) {
+		return latencies.empty() ? 0 : latencies[size_t(p*(latencies.size()-1))];
+	}};
+	printf("reader: %lu frames seen (%lu skipped), %lu torn reads, %lu corrupt\n",
+		seen, seen == 0 ? 0 : prev_frame-first_frame+1 - seen, torn, corrupt);
+	printf("reader: latency mean %.1f us, p50 %.1f us, p99 %.1f us\n",
+		mean, percentile(.5), percentile(.99));
+	printf("reader: %.2f GB/s read in place\n", bytes/secs/1e9);
+	return corrupt == 0 ? 0 : 1;
+}
+
+/**
+ * Publish frames frames of x_dim x z_dim at hz (0: as fast as possible)
+ * to a reader in a child process.
+ */
+int bench(int x_dim, int z_dim, uint64_t frames, int hz, int slots) {
+	std::string name{ "/worldwp_bench_" + std::to_string(getpid()) };
+	worldWp::HeightPublisher publisher{name, x_dim, z_dim, 1, slots};
+	if (!publisher.is_open())
+		return 1;
+
+	pid_t child{ fork() };
+	if (child == 0) {
+		int ret{ read_frames(name, frames-1, 60, true) };
+		fflush(stdout);
+		_exit(ret);
+	}
+
+	uint64_t period_ns( hz == 0 ? 0 : 1000000000/hz ),
+	         write_ns{0},
+	         next{ now_ns() };
+	size_t grid_sz( x_dim*z_dim );
+	for(uint64_t f{0}; f != frames; ++f) {
+		while (now_ns() < next)
+			std::this_thread::yield();
+		next += period_ns;
+
+		uint64_t start{ now_ns() };
+		worldWp::HeightPublisher::Slot slot{ publisher.begin_write() };
+		std::fill(slot.heights, slot.heights + grid_sz, float(f));
+		for(size_t i{0}; i != grid_sz; ++i) {
+			slot.normals[i*3  ] = 0;
+			slot.normals[i*3+1] = 1;
+			slot.normals[i*3+2] = 0;
+		}
+		publisher.end_write();
+		write_ns += now_ns() - start;
+	}
+
+	int status;
+	waitpid(child, &status, 0);
+	printf("publisher: %lu frames of %dx%d, %.1f us per frame, %.2f GB/s\n",
+		frames, x_dim, z_dim, write_ns/1000.0/frames,
+		double(frames)*grid_sz*4*sizeof(float)/write_ns);
+	return WIFEXITED(status) ? WEXITSTATUS(status) : 1;
+}
+
+/**
+ * Benchmark HeightPublisher and HeightReader with a reader in a second
+ * process, or follow the heights published by worldWP --publish <name>.
+ * Usage: heightbench [<x_dim> <z_dim> <frames> <hz> <slots>]
+ *        heightbench --watch <name> <frames>
+ */
+int main(int argc, char** argv) {
+	if (argc == 4 && std::strcmp(argv[1], "--watch") == 0) {
+		worldWp::HeightReader reader{argv[2]};
+		if (!reader.is_open())
+			return 1;
+		printf("%dx%d heights, res %g, %lu frames published\n", reader.get_x_dim(),
+			reader.get_z_dim(), reader.get_res(), reader.get_published());
+		return read_frames(argv[2], reader.get_published()-1 + std::atoi(argv[3]), 3600, false);
+	}
+
+	int x_dim{ argc > 1 ? std::atoi(argv[1]) : 512 },
+	    z_dim{ argc > 2 ? std::atoi(argv[2]) : 512 },
+	    frames{ argc > 3 ? std::atoi(argv[3]) : 2000 },
+	    hz{ argc > 4 ? std::atoi(argv[4]) : 240 },
+	    slots{ argc > 5 ? std::atoi(argv[5]) : 4 };
+	if (x_dim <= 0 || z_dim <= 0 || frames <= 0 || hz < 0 || slots <= 0) {
+		fprintf(stderr, "Usage: %s [<x_dim> <z_dim> <frames> <hz> <slots>]\n"
+		                "       %s --watch <name> <frames>\n", argv[0], argv[0]);
+		return 1;
+	}
+	return bench(x_dim, z_dim, frames, hz, slots);
+}
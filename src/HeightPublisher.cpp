@@ -0,0 +1,90 @@
+#include "HeightPublisher.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <new>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace worldWp {
+
+HeightPublisher::HeightPublisher(
+  const std::string& name,
+  int x_dim, int z_dim, float res,
+  int slot_count
+)
+	: name{ shm_name(name) },
+	  addr{ MAP_FAILED },
+	  size{ sizeof(ShmHeader) + slot_count*shm_slot_bytes(x_dim, z_dim) },
+	  header{ nullptr },
+	  writing{ nullptr } {
+	int fd{ shm_open(this->name.c_str(), O_CREAT | O_RDWR | O_TRUNC, 0644) };
+	if (fd == -1) {
+		fprintf(stderr, "Could not create shared memory %s\n", this->name.c_str());
+		return;
+	}
+	if (ftruncate(fd, size) == 0)
+		addr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if (addr == MAP_FAILED) {
+		fprintf(stderr, "Could not map shared memory %s\n", this->name.c_str());
+		shm_unlink(this->name.c_str());
+		return;
+	}
+
+	//memory is zeroed by ftruncate, so all seqs start even.
+	header = new (addr) ShmHeader;
+	header->version = shm_version;
+	header->x_dim = x_dim;
+	header->z_dim = z_dim;
+	header->res = res;
+	header->slot_count = slot_count;
+	header->slot_bytes = shm_slot_bytes(x_dim, z_dim);
+	header->published.store(0, std::memory_order_relaxed);
+	for(int i{0}; i != slot_count; ++i)
+		new ((char*) addr + sizeof(ShmHeader) + i*header->slot_bytes) ShmSlot{};
+	//readers check the magic last, so it has to be visible last.
+	std::atomic_thread_fence(std::memory_order_release);
+	std::memcpy(header->magic, "WHGT", 4);
+}
+
+HeightPublisher::~HeightPublisher() {
+	if (!is_open())
+		return;
+	munmap(addr, size);
+	shm_unlink(name.c_str());
+}
+
+bool HeightPublisher::is_open() const {
+	return header != nullptr;
+}
+
+HeightPublisher::Slot HeightPublisher::begin_write() {
+	uint64_t frame{ header->published.load(std::memory_order_relaxed) };
+	char* slot{ (char*) addr + sizeof(ShmHeader) + frame%header->slot_count*header->slot_bytes };
+	writing = (ShmSlot*) slot;
+
+	//odd seq: readers of this slot retry or fail.
+	writing->seq.store(writing->seq.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	writing->frame = frame;
+
+	float* heights{ (float*) (slot + sizeof(ShmSlot)) };
+	return {heights, heights + header->x_dim*header->z_dim};
+}
+
+void HeightPublisher::end_write() {
+	writing->time_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+	writing->seq.store(writing->seq.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+	header->published.fetch_add(1, std::memory_order_release);
+}
+
+uint64_t HeightPublisher::get_published() const {
+	return header->published.load(std::memory_order_relaxed);
+}
+
+};
@@ -0,0 +1,44 @@
+#ifndef HEIGHT_PUBLISHER_H_
+#define HEIGHT_PUBLISHER_H_
+
+#include "HeightShm.hpp"
+
+#include <cstdint>
+#include <string>
+
+namespace worldWp {
+
+/**
+ * Publishes height grids with normals into a POSIX shared-memory ring
+ * (see HeightShm.hpp) for other processes. Writing never waits for
+ * readers, readers detect overwritten frames themselves.
+ */
+class HeightPublisher {
+public:
+	//slot to fill, x_dim*z_dim heights and x_dim*z_dim*3 normals.
+	struct Slot {
+		float *heights,
+		      *normals;
+	};
+
+	HeightPublisher(const std::string& name, int x_dim, int z_dim, float res, int slot_count = 4);
+	//also removes the shared memory.
+	~HeightPublisher();
+
+	bool is_open() const;
+	//slot of the next frame, readers skip it until end_write.
+	Slot begin_write();
+	void end_write();
+	//frames published so far.
+	uint64_t get_published() const;
+private:
+	std::string name;
+	void* addr;
+	size_t size;
+	ShmHeader* header;
+	ShmSlot* writing;
+};
+
+};
+
+#endif
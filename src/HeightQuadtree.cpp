@@ -0,0 +1,238 @@
+#include "HeightQuadtree.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+struct Node {
+	int level, x, z;
+	float t_enter;
+};
+
+//grid-dimensions are ints, so there are at most 32 levels.
+const int max_levels{32};
+
+//slab-test of ray against box, t_enter/t_exit are clipped to [0, inf).
+bool intersect_box(
+  const worldWp::HeightQuadtree::Ray& ray,
+  const float box_min[3], const float box_max[3],
+  float& t_enter, float& t_exit
+) {
+	const float *origin{ &ray.origin.x },
+	            *dir{ &ray.dir.x };
+	t_enter = 0;
+	t_exit = std::numeric_limits<float>::infinity();
+	for(int i{0}; i != 3; ++i) {
+		if (dir[i] == 0) {
+			if (origin[i] < box_min[i] || origin[i] > box_max[i])
+				return false;
+			continue;
+		}
+		float inv{ 1/dir[i] },
+		      t0{ (box_min[i]-origin[i])*inv },
+		      t1{ (box_max[i]-origin[i])*inv };
+		if (t0 > t1)
+			std::swap(t0, t1);
+		t_enter = std::max(t_enter, t0);
+		t_exit = std::min(t_exit, t1);
+		if (t_enter > t_exit)
+			return false;
+	}
+	return true;
+}
+
+//two-sided Moeller-Trumbore.
+bool intersect_triangle(
+  const worldWp::HeightQuadtree::Ray& ray,
+  bx::Vec3 a, bx::Vec3 b, bx::Vec3 c,
+  float& t
+) {
+	bx::Vec3 e1{ bx::sub(b, a) },
+	         e2{ bx::sub(c, a) },
+	         p{ bx::cross(ray.dir, e2) };
+	float det{ bx::dot(e1, p) };
+	if (std::abs(det) < 1e-12f)
+		return false;
+	float inv_det{ 1/det };
+	bx::Vec3 s{ bx::sub(ray.origin, a) };
+	float u{ bx::dot(s, p)*inv_det };
+	if (u < 0 || u > 1)
+		return false;
+	bx::Vec3 q{ bx::cross(s, e1) };
+	float v{ bx::dot(ray.dir, q)*inv_det };
+	if (v < 0 || u+v > 1)
+		return false;
+	t = bx::dot(e2, q)*inv_det;
+	return t >= 0;
+}
+
+};
+
+namespace worldWp {
+
+HeightQuadtree::HeightQuadtree(const util::PlaneSpecs& ms, const float* heights)
+	: ms{ ms },
+	  heights(heights, heights + ms.x_dim*ms.z_dim) {
+	int x_sz{ms.x_dim-1},
+	    z_sz{ms.z_dim-1};
+	while (true) {
+		levels.push_back({x_sz, z_sz,
+			std::vector<float>(x_sz*z_sz), std::vector<float>(x_sz*z_sz)});
+		if (x_sz == 1 && z_sz == 1)
+			break;
+		x_sz = (x_sz+1)/2;
+		z_sz = (z_sz+1)/2;
+	}
+	refit(0, 0, ms.x_dim-1, ms.z_dim-1);
+}
+
+float HeightQuadtree::grid_x(int x) const {
+	return x*ms.res - (ms.x_dim-1)*ms.res/2.0f;
+}
+
+float HeightQuadtree::grid_z(int z) const {
+	return z*ms.res - (ms.z_dim-1)*ms.res/2.0f;
+}
+
+void HeightQuadtree::update(const float* heights) {
+	std::copy(heights, heights + ms.x_dim*ms.z_dim, this->heights.begin());
+	refit(0, 0, ms.x_dim-1, ms.z_dim-1);
+}
+
+void HeightQuadtree::update(const float* heights, int x0, int z0, int x1, int z1) {
+	for(int i{x0}; i != x1; ++i)
+		std::copy(heights + i*ms.z_dim + z0, heights + i*ms.z_dim + z1,
+		          this->heights.begin() + i*ms.z_dim + z0);
+	//quads left of/above the rectangle use its first row/column too.
+	refit(std::max(x0-1, 0), std::max(z0-1, 0),
+	      std::min(x1, ms.x_dim-1), std::min(z1, ms.z_dim-1));
+}
+
+void HeightQuadtree::refit(int quad_x0, int quad_z0, int quad_x1, int quad_z1) {
+	Level& quads{ levels[0] };
+	for(int i{quad_x0}; i != quad_x1; ++i)
+		for(int j{quad_z0}; j != quad_z1; ++j) {
+			const float *row0{ &heights[i*ms.z_dim + j] },
+			            *row1{ row0 + ms.z_dim };
+			quads.min[i*quads.z_sz + j] = std::min({row0[0], row0[1], row1[0], row1[1]});
+			quads.max[i*quads.z_sz + j] = std::max({row0[0], row0[1], row1[0], row1[1]});
+		}
+
+	for(size_t l{1}; l != levels.size(); ++l) {
+		const Level& child{ levels[l-1] };
+		Level& lvl{ levels[l] };
+		quad_x0 /= 2; quad_z0 /= 2;
+		quad_x1 = (quad_x1+1)/2; quad_z1 = (quad_z1+1)/2;
+		for(int i{quad_x0}; i != quad_x1; ++i)
+			for(int j{quad_z0}; j != quad_z1; ++j) {
+				float mn{ std::numeric_limits<float>::infinity() },
+				      mx{ -std::numeric_limits<float>::infinity() };
+				for(int ci{i*2}; ci != std::min(i*2+2, child.x_sz); ++ci)
+					for(int cj{j*2}; cj != std::min(j*2+2, child.z_sz); ++cj) {
+						mn = std::min(mn, child.min[ci*child.z_sz + cj]);
+						mx = std::max(mx, child.max[ci*child.z_sz + cj]);
+					}
+				lvl.min[i*lvl.z_sz + j] = mn;
+				lvl.max[i*lvl.z_sz + j] = mx;
+			}
+	}
+}
+
+float HeightQuadtree::height_at(float x, float z) const {
+	float gx{ bx::clamp((x + (ms.x_dim-1)*ms.res/2.0f)/ms.res, 0.0f, float(ms.x_dim-1)) },
+	      gz{ bx::clamp((z + (ms.z_dim-1)*ms.res/2.0f)/ms.res, 0.0f, float(ms.z_dim-1)) };
+	int i{ std::min(int(gx), ms.x_dim-2) },
+	    j{ std::min(int(gz), ms.z_dim-2) };
+	float fx{gx-i},
+	      fz{gz-j};
+	const float *row0{ &heights[i*ms.z_dim + j] },
+	            *row1{ row0 + ms.z_dim };
+	return bx::lerp(bx::lerp(row0[0], row0[1], fz),
+	                bx::lerp(row1[0], row1[1], fz), fx);
+}
+
+bool HeightQuadtree::intersect_quad(const Ray& ray, int x, int z, float& t) const {
+	auto vert{ [&](int i, int j) {
+		return bx::Vec3{ grid_x(i), heights[i*ms.z_dim + j], grid_z(j) };
+	}};
+	//same split as the triangles of Plane.
+	bx::Vec3 v1{ vert(x, z) },
+	         v2{ vert(x, z+1) },
+	         v3{ vert(x+1, z) },
+	         v4{ vert(x+1, z+1) };
+
+	float t_a, t_b;
+	bool hit_a{ intersect_triangle(ray, v1, v2, v3, t_a) },
+	     hit_b{ intersect_triangle(ray, v2, v4, v3, t_b) };
+	if (hit_a && hit_b)
+		t = std::min(t_a, t_b);
+	else if (hit_a)
+		t = t_a;
+	else if (hit_b)
+		t = t_b;
+	return hit_a || hit_b;
+}
+
+HeightQuadtree::Hit HeightQuadtree::raycast(const Ray& ray) const {
+	Hit hit{ false, std::numeric_limits<float>::infinity(), {0, 0, 0} };
+
+	//nodes are pushed far to near, so the nearest one is popped first.
+	//each level pops one node and pushes at most 4.
+	Node stack[3*max_levels + 1];
+	int stack_sz{0};
+	stack[stack_sz++] = { int(levels.size())-1, 0, 0, 0 };
+	while (stack_sz != 0) {
+		Node n{ stack[--stack_sz] };
+		if (n.t_enter > hit.t)
+			continue;
+
+		if (n.level == 0) {
+			float t;
+			if (intersect_quad(ray, n.x, n.z, t) && t < hit.t) {
+				hit.hit = true;
+				hit.t = t;
+			}
+			continue;
+		}
+
+		const Level& child{ levels[n.level-1] };
+		//cells of child span 2^(level-1) quads.
+		int cell_sz{ 1 << (n.level-1) };
+		Node children[4];
+		int child_count{0};
+		for(int ci{n.x*2}; ci != std::min(n.x*2+2, child.x_sz); ++ci)
+			for(int cj{n.z*2}; cj != std::min(n.z*2+2, child.z_sz); ++cj) {
+				float box_min[3] {
+					grid_x(ci*cell_sz),
+					child.min[ci*child.z_sz + cj],
+					grid_z(cj*cell_sz) };
+				float box_max[3] {
+					grid_x(std::min((ci+1)*cell_sz, ms.x_dim-1)),
+					child.max[ci*child.z_sz + cj],
+					grid_z(std::min((cj+1)*cell_sz, ms.z_dim-1)) };
+				float t_enter, t_exit;
+				if (intersect_box(ray, box_min, box_max, t_enter, t_exit) && t_enter <= hit.t)
+					children[child_count++] = {n.level-1, ci, cj, t_enter};
+			}
+		std::sort(children, children+child_count, [](const Node& a, const Node& b) {
+			return a.t_enter > b.t_enter;
+		});
+		std::copy(children, children+child_count, stack+stack_sz);
+		stack_sz += child_count;
+	}
+
+	if (hit.hit)
+		hit.pos = bx::add(ray.origin, bx::mul(ray.dir, hit.t));
+	return hit;
+}
+
+void HeightQuadtree::raycast(const Ray* rays, Hit* hits, int count) const {
+	util::parallel_for(count, [&](int begin, int end) {
+		for(int i{begin}; i != end; ++i)
+			hits[i] = raycast(rays[i]);
+	});
+}
+
+};
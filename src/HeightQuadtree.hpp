@@ -0,0 +1,61 @@
+#ifndef HEIGHT_QUADTREE_H_
+#define HEIGHT_QUADTREE_H_
+
+#include "Util.hpp"
+
+#include "bx/math.h"
+
+#include <vector>
+
+namespace worldWp {
+
+/**
+ * Min/max-pyramid over the quads of a height grid for ray casts and height
+ * lookups. Positions are in the model space of Plane (grid centered on 0).
+ */
+class HeightQuadtree {
+public:
+	struct Ray {
+		bx::Vec3 origin, dir;
+	};
+
+	struct Hit {
+		bool hit;
+		//distance along ray in multiples of dir.
+		float t;
+		bx::Vec3 pos;
+	};
+
+	HeightQuadtree(const util::PlaneSpecs& ms, const float* heights);
+
+	//copy heights of all vertices and refit the pyramid.
+	void update(const float* heights);
+	//copy heights of vertices [x0, x1) x [z0, z1) and refit only above them.
+	void update(const float* heights, int x0, int z0, int x1, int z1);
+
+	//bilinear height at x/z, clamped to the grid.
+	float height_at(float x, float z) const;
+	//nearest intersection of ray with the triangles of the grid.
+	Hit raycast(const Ray& ray) const;
+	//raycast for count rays, spread over the threads of util::parallel_for.
+	void raycast(const Ray* rays, Hit* hits, int count) const;
+private:
+	struct Level {
+		int x_sz, z_sz;
+		std::vector<float> min, max;
+	};
+
+	util::PlaneSpecs ms;
+	std::vector<float> heights;
+	//levels[0] has one cell per quad, last level a single cell.
+	std::vector<Level> levels;
+
+	void refit(int quad_x0, int quad_z0, int quad_x1, int quad_z1);
+	bool intersect_quad(const Ray& ray, int x, int z, float& t) const;
+	float grid_x(int x) const;
+	float grid_z(int z) const;
+};
+
+};
+
+#endif
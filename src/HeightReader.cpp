@@ -0,0 +1,109 @@
+#include "HeightReader.hpp"
+
+#include <cstdio>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace worldWp {
+
+HeightReader::HeightReader(const std::string& name)
+	: addr{ MAP_FAILED },
+	  size{0},
+	  header{ nullptr } {
+	int fd{ shm_open(shm_name(name).c_str(), O_RDONLY, 0) };
+	if (fd == -1) {
+		fprintf(stderr, "Could not open shared memory %s\n", shm_name(name).c_str());
+		return;
+	}
+	struct stat st;
+	if (fstat(fd, &st) == 0 && size_t(st.st_size) >= sizeof(ShmHeader)) {
+		size = st.st_size;
+		addr = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+	}
+	close(fd);
+	if (addr == MAP_FAILED) {
+		fprintf(stderr, "Could not map shared memory %s\n", shm_name(name).c_str());
+		return;
+	}
+
+	const ShmHeader* h{ (const ShmHeader*) addr };
+	bool valid{ std::memcmp(h->magic, "WHGT", 4) == 0 };
+	std::atomic_thread_fence(std::memory_order_acquire);
+	if (!valid || h->version != shm_version
+	 || sizeof(ShmHeader) + h->slot_count*h->slot_bytes > size) {
+		fprintf(stderr, "%s is not a height-grid of this version\n", shm_name(name).c_str());
+		munmap((void*) addr, size);
+		addr = MAP_FAILED;
+		return;
+	}
+	header = h;
+}
+
+HeightReader::~HeightReader() {
+	if (addr != MAP_FAILED)
+		munmap((void*) addr, size);
+}
+
+bool HeightReader::is_open() const {
+	return header != nullptr;
+}
+
+int HeightReader::get_x_dim() const {
+	return header->x_dim;
+}
+
+int HeightReader::get_z_dim() const {
+	return header->z_dim;
+}
+
+float HeightReader::get_res() const {
+	return header->res;
+}
+
+uint64_t HeightReader::get_published() const {
+	return header->published.load(std::memory_order_acquire);
+}
+
+bool HeightReader::read_latest(const std::function<void(const Snapshot&)>& fn, int retries) const {
+	for(int i{0}; i <= retries; ++i) {
+		uint64_t published{ get_published() };
+		if (published == 0)
+			return false;
+		const char* slot{ (const char*) addr + sizeof(ShmHeader)
+		                + (published-1)%header->slot_count*header->slot_bytes };
+		const ShmSlot* s{ (const ShmSlot*) slot };
+
+		uint64_t seq{ s->seq.load(std::memory_order_acquire) };
+		//being written, the publisher lapped the ring.
+		if (seq % 2 == 1)
+			continue;
+		const float* heights{ (const float*) (slot + sizeof(ShmSlot)) };
+		fn({s->frame, s->time_ns, heights, heights + header->x_dim*header->z_dim});
+
+		std::atomic_thread_fence(std::memory_order_acquire);
+		if (s->seq.load(std::memory_order_relaxed) == seq)
+			return true;
+	}
+	return false;
+}
+
+bool HeightReader::copy_latest(
+  std::vector<float>& heights,
+  std::vector<float>& normals,
+  uint64_t& frame
+) const {
+	size_t grid_sz( header->x_dim*header->z_dim );
+	heights.resize(grid_sz);
+	normals.resize(grid_sz*3);
+	return read_latest([&](const Snapshot& snap) {
+		std::memcpy(heights.data(), snap.heights, grid_sz*sizeof(float));
+		std::memcpy(normals.data(), snap.normals, grid_sz*3*sizeof(float));
+		frame = snap.frame;
+	});
+}
+
+};
@@ -0,0 +1,55 @@
+#ifndef HEIGHT_READER_H_
+#define HEIGHT_READER_H_
+
+#include "HeightShm.hpp"
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace worldWp {
+
+/**
+ * Reads the heights published by a HeightPublisher in another process.
+ * Nothing is copied: callbacks get pointers into the shared memory and
+ * are told afterwards whether the frame stayed intact.
+ */
+class HeightReader {
+public:
+	struct Snapshot {
+		uint64_t frame,
+		         time_ns;
+		//x_dim*z_dim heights and x_dim*z_dim*3 normals.
+		const float *heights,
+		            *normals;
+	};
+
+	explicit HeightReader(const std::string& name);
+	~HeightReader();
+
+	bool is_open() const;
+	int get_x_dim() const;
+	int get_z_dim() const;
+	float get_res() const;
+	//frames published so far, 0 if none yet.
+	uint64_t get_published() const;
+
+	/**
+	 * Call fn with the latest frame, retried up to retries times if the
+	 * publisher overwrote it meanwhile.
+	 * @return false if no frame was published yet or every try was torn,
+	 * results of fn have to be dropped then.
+	 */
+	bool read_latest(const std::function<void(const Snapshot&)>& fn, int retries = 3) const;
+	//copy of the latest frame into heights and normals.
+	bool copy_latest(std::vector<float>& heights, std::vector<float>& normals, uint64_t& frame) const;
+private:
+	const void* addr;
+	size_t size;
+	const ShmHeader* header;
+};
+
+};
+
+#endif
@@ -0,0 +1,56 @@
+#ifndef HEIGHT_SHM_H_
+#define HEIGHT_SHM_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace worldWp {
+
+/**
+ * Layout of the shared memory written by HeightPublisher and read by
+ * HeightReader: ShmHeader, then header.slot_count slots of slot_bytes each.
+ * A slot is a ShmSlot followed by x_dim*z_dim heights and x_dim*z_dim*3
+ * normals (floats, index i*z_dim + j like Plane).
+ * Frame n is written to slot n%slot_count, so readers of the latest frame
+ * have slot_count-1 frames of time before it is overwritten. Every slot is
+ * guarded by a seqlock: seq is odd while the slot is written.
+ */
+const uint32_t shm_version{1};
+
+struct alignas(64) ShmHeader {
+	char magic[4];
+	uint32_t version;
+	int32_t x_dim, z_dim;
+	float res;
+	uint32_t slot_count;
+	uint64_t slot_bytes;
+	//number of frames published, the latest is published-1.
+	alignas(64) std::atomic<uint64_t> published;
+};
+
+struct alignas(64) ShmSlot {
+	std::atomic<uint64_t> seq;
+	uint64_t frame;
+	//steady_clock in ns when the frame was published, for latency.
+	uint64_t time_ns;
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free,
+	"seqlocks in shared memory need lock-free atomics");
+
+inline size_t shm_slot_bytes(int x_dim, int z_dim) {
+	size_t bytes{ sizeof(ShmSlot) + size_t(x_dim)*z_dim*4*sizeof(float) };
+	//keep every slot on its own cache-lines.
+	return (bytes + 63) / 64 * 64;
+}
+
+//shm_open needs a leading '/'.
+inline std::string shm_name(const std::string& name) {
+	return name.empty() || name[0] != '/' ? "/" + name : name;
+}
+
+};
+
+#endif
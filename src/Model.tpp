@@ -2,43 +2,237 @@
 #define MODEL_H_
 
 #include "bgfx/bgfx.h"
+#include "Resources.hpp"
 #include "Util.hpp"
 
+#include <algorithm>
+
 namespace worldWp {
 
+/**
+ * Owns vertices, indices and the bgfx-buffers made from them.
+ * Buffers are created on first use and may be released by ResourceManager
+ * between frames, so get handles every frame instead of keeping them.
+ */
 template<typename T>
-class Model {
+class Model : public ModelBase {
 public:
 	Model(int vert_sz, int indzs_sz, uint64_t indzs_state)
 		: vert_sz{vert_sz},
 		  indzs_sz{indzs_sz},
+		  vert_cap{vert_sz},
+		  indzs_cap{indzs_sz},
 		  indzs_state{indzs_state},
+		  vbh BGFX_INVALID_HANDLE,
+		  dyn_vbh BGFX_INVALID_HANDLE,
+		  ibh BGFX_INVALID_HANDLE,
+		  dynamic{false},
 		  verts{ new util::PosNormalColorVertex[vert_sz] },
 		  indzs{ new T[indzs_sz] } { }
 
+	~Model() {
+		release_gpu();
+		free_arrays();
+	}
+
 	bgfx::VertexBufferHandle getVBufferHandle() {
-		return bgfx::createVertexBuffer(
-			bgfx::makeRef(verts,
-				vert_sz*sizeof(util::PosNormalColorVertex)),
-				util::PosNormalColorVertex::layout);
+		touch();
+		if (!bgfx::isValid(vbh)) {
+			restore_cpu();
+			vbh = bgfx::createVertexBuffer(
+				bgfx::makeRef(verts,
+					vert_sz*sizeof(util::PosNormalColorVertex)),
+					util::PosNormalColorVertex::layout);
+		}
+		return vbh;
+	}
+
+	//verts changed, next getVBufferHandle uploads them again,
+	//the dynamic vertex buffer is updated right away.
+	void invalidateVBuffer() {
+		if (bgfx::isValid(vbh))
+			bgfx::destroy(vbh);
+		vbh = BGFX_INVALID_HANDLE;
+		updateVBuffer(0, vert_sz);
+	}
+
+	/**
+	 * Draw from the dynamic vertex buffer from now on, for models that are
+	 * updated in parts. It is created by the next set_buffers.
+	 */
+	void make_dynamic() {
+		if (bgfx::isValid(vbh))
+			bgfx::destroy(vbh);
+		vbh = BGFX_INVALID_HANDLE;
+		dynamic = true;
+	}
+
+	bool is_dynamic() const {
+		return dynamic;
+	}
+
+	//for models that are updated in parts, see updateVBuffer.
+	bgfx::DynamicVertexBufferHandle getDynVBufferHandle() {
+		touch();
+		if (!bgfx::isValid(dyn_vbh)) {
+			restore_cpu();
+			dyn_vbh = bgfx::createDynamicVertexBuffer(
+				bgfx::makeRef(verts,
+					vert_sz*sizeof(util::PosNormalColorVertex)),
+					util::PosNormalColorVertex::layout);
+		}
+		return dyn_vbh;
+	}
+
+	/**
+	 * Upload vertices [start, start+count) to the dynamic vertex buffer.
+	 * Does nothing if it doesn't exist, it gets all vertices once created.
+	 */
+	void updateVBuffer(int start, int count) {
+		if (bgfx::isValid(dyn_vbh))
+			bgfx::update(dyn_vbh, start, bgfx::makeRef(verts+start,
+				count*sizeof(util::PosNormalColorVertex)));
 	}
 
 	bgfx::IndexBufferHandle getIBufferHandle() {
-		return bgfx::createIndexBuffer(bgfx::makeRef(indzs,
-			indzs_sz*sizeof(T)),
-			//Change Buffer type acording to T.
-			(std::is_same<T, uint32_t>::value ? BGFX_BUFFER_INDEX32 : BGFX_BUFFER_NONE));
+		touch();
+		if (!bgfx::isValid(ibh)) {
+			restore_cpu();
+			ibh = bgfx::createIndexBuffer(bgfx::makeRef(indzs,
+				indzs_sz*sizeof(T)),
+				//Change Buffer type acording to T.
+				(std::is_same<T, uint32_t>::value ? BGFX_BUFFER_INDEX32 : BGFX_BUFFER_NONE));
+		}
+		return ibh;
 	}
 
-	uint64_t get_indzs_state() {
+	uint64_t get_indzs_state() const override {
 		return indzs_state;
 	}
+
+	void set_buffers(int) override {
+		if (dynamic)
+			bgfx::setVertexBuffer(0, getDynVBufferHandle());
+		else
+			bgfx::setVertexBuffer(0, getVBufferHandle());
+		bgfx::setIndexBuffer(getIBufferHandle());
+	}
+
+	void append_to(
+	  std::vector<util::PosNormalColorVertex>& verts,
+	  std::vector<uint32_t>& indzs
+	) override {
+		restore_cpu();
+		uint32_t offset( verts.size() );
+		verts.insert(verts.end(), this->verts, this->verts+vert_sz);
+		for(int i{0}; i != indzs_sz; ++i)
+			indzs.push_back(this->indzs[i]+offset);
+	}
+
+	//nullptr while released, see release_cpu.
+	const util::PosNormalColorVertex* get_verts() const {
+		return verts;
+	}
+
+	int get_vert_sz() const {
+		return vert_sz;
+	}
+
+	const T* get_indzs() const {
+		return indzs;
+	}
+
+	int get_indzs_sz() const {
+		return indzs_sz;
+	}
+
+	size_t get_cpu_bytes() const override {
+		if (verts == nullptr)
+			return 0;
+		return vert_cap*sizeof(util::PosNormalColorVertex) + indzs_cap*sizeof(T);
+	}
+
+	size_t get_gpu_bytes() const override {
+		size_t vbuf_bytes{ vert_sz*sizeof(util::PosNormalColorVertex) };
+		return (bgfx::isValid(vbh) ? vbuf_bytes : 0)
+		     + (bgfx::isValid(dyn_vbh) ? vbuf_bytes : 0)
+		     + (bgfx::isValid(ibh) ? indzs_sz*sizeof(T) : 0);
+	}
+
+	void release_gpu() override {
+		if (bgfx::isValid(vbh))
+			bgfx::destroy(vbh);
+		if (bgfx::isValid(dyn_vbh))
+			bgfx::destroy(dyn_vbh);
+		if (bgfx::isValid(ibh))
+			bgfx::destroy(ibh);
+		vbh = BGFX_INVALID_HANDLE;
+		dyn_vbh = BGFX_INVALID_HANDLE;
+		ibh = BGFX_INVALID_HANDLE;
+	}
+
+	bool release_cpu() override {
+		if (!can_rebuild() || verts == nullptr)
+			return false;
+		//existing buffers still draw the model.
+		free_arrays();
+		verts = nullptr;
+		indzs = nullptr;
+		return true;
+	}
 private:
 	int vert_sz, indzs_sz;
+	//allocated lengths of verts and indzs, shrinking keeps them.
+	int vert_cap, indzs_cap;
 	uint64_t indzs_state;
+	bgfx::VertexBufferHandle vbh;
+	bgfx::DynamicVertexBufferHandle dyn_vbh;
+	bgfx::IndexBufferHandle ibh;
+	bool dynamic;
 protected:
 	util::PosNormalColorVertex *verts;
 	T *indzs;
+
+	//models that can fill verts and indzs again override both, see release_cpu.
+	virtual bool can_rebuild() const {
+		return false;
+	}
+	virtual void rebuild() { }
+
+	//for models whose size changes, contents are lost when growing.
+	void resize(int vert_sz, int indzs_sz) {
+		//buffers may reference the old arrays.
+		release_gpu();
+		if (vert_sz > vert_cap || indzs_sz > indzs_cap) {
+			free_arrays();
+			vert_cap = std::max(vert_sz, vert_cap);
+			indzs_cap = std::max(indzs_sz, indzs_cap);
+			verts = new util::PosNormalColorVertex[vert_cap];
+			indzs = new T[indzs_cap];
+			//old content isn't kept, callers refill them.
+		}
+		this->vert_sz = vert_sz;
+		this->indzs_sz = indzs_sz;
+	}
+private:
+	//allocate and fill the arrays again after release_cpu.
+	void restore_cpu() {
+		if (verts != nullptr)
+			return;
+		verts = new util::PosNormalColorVertex[vert_cap];
+		indzs = new T[indzs_cap];
+		rebuild();
+	}
+
+	//bgfx may still read them through makeRef for two frames.
+	void free_arrays() {
+		util::PosNormalColorVertex* v{verts};
+		T* i{indzs};
+		ResourceManager::get().defer_free([v, i]() {
+			delete[] v;
+			delete[] i;
+		});
+	}
 };
 
 };
@@ -0,0 +1,123 @@
+#include "NoiseTiles.hpp"
+
+#include "Util.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+const int tile_mask{worldWp::NoiseTiles::tile_sz - 1};
+const float quantize{32767};
+
+namespace worldWp {
+
+NoiseTiles& NoiseTiles::get() {
+	static NoiseTiles noise_tiles;
+	return noise_tiles;
+}
+
+NoiseTiles::Sampler NoiseTiles::get_sampler(const FastNoise& fn, int octaves) {
+	//1 << k overflows past 31 octaves, far beyond max_octaves.
+	octaves = std::min(std::max(octaves, 1), max_octaves);
+	Sampler sampler;
+	sampler.texel_scale = fn.GetFrequency()*texels_per_cell;
+
+	//normalize to the range of a single octave.
+	float amp_sum{0};
+	for(int k{0}; k < octaves; ++k)
+		amp_sum += 1.0f/(1 << k);
+	sampler.amplitude = 1/(amp_sum*quantize);
+
+	int seed{ fn.GetSeed() },
+	    pooled{ (seed%seed_pool + seed_pool) % seed_pool };
+
+	//generate under the lock, planes needing the same tile wait for it.
+	std::lock_guard<std::mutex> lock{mutex};
+	for(int k{0}; k < octaves; ++k) {
+		std::shared_ptr<const Tile>& tile{ tiles[{pooled, k}] };
+		if (!tile) {
+			FastNoise octave_fn{fn};
+			octave_fn.SetNoiseType(FastNoise::Perlin);
+			octave_fn.SetSeed(pooled + k*seed_pool);
+			tile = generate(octave_fn);
+		}
+		sampler.octaves.push_back(tile);
+
+		//tiles are periodic, any offset is fine.
+		uint32_t hash{ uint32_t(seed)*0x9e3779b1 ^ uint32_t(k)*0x85ebca77 };
+		hash ^= hash >> 15;
+		hash *= 0x2c1b3c6d;
+		hash ^= hash >> 12;
+		sampler.offsets.push_back({float(hash & tile_mask), float((hash >> 16) & tile_mask)});
+	}
+	return sampler;
+}
+
+void NoiseTiles::clear() {
+	std::lock_guard<std::mutex> lock{mutex};
+	tiles.clear();
+}
+
+size_t NoiseTiles::get_bytes() const {
+	std::lock_guard<std::mutex> lock{mutex};
+	size_t bytes{0};
+	for(const auto& tile : tiles)
+		bytes += tile.second->texels.size()*sizeof(int16_t);
+	return bytes;
+}
+
+std::shared_ptr<const NoiseTiles::Tile> NoiseTiles::generate(const FastNoise& fn) {
+	std::shared_ptr<Tile> tile{ new Tile };
+	tile->texels.resize(tile_sz*tile_sz);
+
+	//noise-coordinates per texel and per tile.
+	float step{ 1/(fn.GetFrequency()*texels_per_cell) },
+	      period{ step*tile_sz };
+	util::parallel_for(tile_sz, [&](int begin, int end) {
+		for(int a{begin}; a != end; ++a)
+			for(int b{0}; b != tile_sz; ++b) {
+				float x{a*step}, z{b*step},
+				      u{float(a)/tile_sz}, v{float(b)/tile_sz};
+				float val{ fn.GetNoise(x,        z       )*(1-u)*(1-v)
+				         + fn.GetNoise(x-period, z       )*u*(1-v)
+				         + fn.GetNoise(x,        z-period)*(1-u)*v
+				         + fn.GetNoise(x-period, z-period)*u*v };
+				tile->texels[a*tile_sz + b] =
+					std::lround(std::max(-1.0f, std::min(1.0f, val))*quantize);
+			}
+	});
+	return tile;
+}
+
+void NoiseTiles::Sampler::sample_row(float x, float z0, float dz, int n, float* out) const {
+	std::fill(out, out+n, 0);
+	//the interpolated row, wrapped around by one texel.
+	float row[tile_sz+1];
+
+	float scale{texel_scale},
+	      amp{amplitude};
+	for(size_t k{0}; k != octaves.size(); ++k) {
+		const std::shared_ptr<const Tile>& tile{ octaves[k] };
+		float ox{ offsets[k].first },
+		      oz{ offsets[k].second };
+		//both rows are blended once, lookups along the row are then linear.
+		float tx{ x*scale + ox },
+		      wx{ tx - std::floor(tx) };
+		int ix{ int(std::floor(tx)) };
+		const int16_t *r0{ &tile->texels[(ix & tile_mask)*tile_sz] },
+		              *r1{ &tile->texels[((ix+1) & tile_mask)*tile_sz] };
+		for(int t{0}; t != tile_sz; ++t)
+			row[t] = r0[t] + wx*(r1[t] - r0[t]);
+		row[tile_sz] = row[0];
+
+		for(int j{0}; j != n; ++j) {
+			float tz{ (z0 + j*dz)*scale + oz },
+			      fz{ std::floor(tz) };
+			int iz{ int(fz) & tile_mask };
+			out[j] += amp*(row[iz] + (tz-fz)*(row[iz+1] - row[iz]));
+		}
+		scale *= 2;
+		amp /= 2;
+	}
+}
+
+};
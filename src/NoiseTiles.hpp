@@ -0,0 +1,86 @@
+#ifndef NOISE_TILES_H_
+#define NOISE_TILES_H_
+
+#include "FastNoise.h"
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace worldWp {
+
+/**
+ * Cache of periodic perlin-noise tiles per seed and octave, shared by all
+ * planes. Sampling a tile replaces evaluating gradient noise with two
+ * table-lookups per point.
+ * Tiles only exist for seed_pool seeds, other seeds use the tiles of
+ * seed%seed_pool at an offset derived from the seed, so new terrains
+ * rarely have to generate tiles.
+ */
+class NoiseTiles {
+public:
+	//texels per side of a tile, power of two.
+	static const int tile_sz{256};
+	//texels per cell of the noise-lattice, a tile repeats after
+	//tile_sz/texels_per_cell cells.
+	static const int texels_per_cell{16};
+	static const int seed_pool{16};
+	//octaves beyond would add noise below int16-quantization.
+	static const int max_octaves{16};
+
+	//noise quantized to int16, tile_sz x tile_sz.
+	struct Tile {
+		std::vector<int16_t> texels;
+	};
+
+	/**
+	 * Fractal noise of the tiles of one FastNoise, like FastNoise::FBM:
+	 * octave k has double the frequency and half the amplitude of octave
+	 * k-1. Its tile is generated with the seed pooled + k*seed_pool
+	 * (pooled = seed%seed_pool), so tiles of different pooled seeds and
+	 * octaves never share a seed, and it is sampled at an offset hashed
+	 * from seed and k.
+	 */
+	class Sampler {
+	public:
+		/**
+		 * out[j] = noise(x, z0 + j*dz) for j in [0, n), coordinates are the
+		 * same as for FastNoise::GetNoise.
+		 */
+		void sample_row(float x, float z0, float dz, int n, float* out) const;
+	private:
+		friend class NoiseTiles;
+		std::vector<std::shared_ptr<const Tile>> octaves;
+		//texel-offset of each octave.
+		std::vector<std::pair<float, float>> offsets;
+		//scale from noise- to texel-coordinates in the first octave.
+		float texel_scale;
+		//amplitude of the first octave, includes dequantization.
+		float amplitude;
+	};
+
+	static NoiseTiles& get();
+
+	//tiles of fn for octaves octaves (clamped to 1..max_octaves),
+	//generated if not cached yet.
+	Sampler get_sampler(const FastNoise& fn, int octaves);
+	//drop all cached tiles, samplers keep the ones they use alive.
+	void clear();
+	size_t get_bytes() const;
+private:
+	NoiseTiles() = default;
+
+	mutable std::mutex mutex;
+	//by pooled seed and octave.
+	std::map<std::pair<int, int>, std::shared_ptr<const Tile>> tiles;
+
+	//tileable noise of fn by blending four samples, so opposite edges match.
+	static std::shared_ptr<const Tile> generate(const FastNoise& fn);
+};
+
+};
+
+#endif
@@ -1,11 +1,14 @@
 #include "Plane.hpp"
 
+#include "Grid.hpp"
 #include "Util.hpp"
 #include "bx/math.h"
 
+#include <algorithm>
 #include <cmath>
 #include <iostream>
 #include <ostream>
+#include <vector>
 
 int ibuf_indzs[2],
     vbuf_indzs[2];
@@ -21,20 +24,24 @@ Plane::Plane(
   const FastNoise& fn,
   const worldWp::util::NoiseMods& nm,
   const uint32_t abgr,
-  const float base_start
+  const float base_start,
+  const int tile_octaves
 )
 	: Model{
-		//assign vbuf and ibuf-sizes in super-constructor.
-		(vbuf_indzs[0] = ms.x_dim*ms.z_dim*2) +
-		(vbuf_indzs[1] = vbuf_indzs[0] +
+		//assign vbuf and ibuf-sizes in super-constructor,
+		//[1] is the end of the base and thereby the size.
+		(vbuf_indzs[0] = ms.x_dim*ms.z_dim*2,
+		 vbuf_indzs[1] = vbuf_indzs[0] +
 		(base_start != 0 ? (ms.x_dim-1 + ms.z_dim-1)*2 + 4 : 0)),
 
-		(ibuf_indzs[0] = (ms.x_dim-1)*(ms.z_dim-1)*2*2*3) +
-		(ibuf_indzs[1] = ibuf_indzs[0] +
+		(ibuf_indzs[0] = (ms.x_dim-1)*(ms.z_dim-1)*2*2*3,
+		 ibuf_indzs[1] = ibuf_indzs[0] +
 		(base_start != 0 ? ((ms.x_dim-1)+(ms.z_dim-1))*2*2*3 + 6 : 0)),
 		0x0000000000000000 },
 	  ms{ ms },
-	  nm{ nm } {
+	  nm{ nm },
+	  tile_octaves{ tile_octaves },
+	  dirty_x0{0}, dirty_z0{0}, dirty_x1{0}, dirty_z1{0} {
 	add_plane_vertices(fn, abgr);
 	add_normals();
 	if (base_start != 0) {
@@ -42,71 +49,96 @@ Plane::Plane(
 		add_base_indizes();
 	}
 
-	//fill indzs.
+	grid::fill_indzs(indzs, ms.x_dim, ms.z_dim);
+}
+
+void Plane::add_normals() {
+	grid::add_normals(verts, ms.x_dim, ms.z_dim, 0, 0, ms.x_dim-1, ms.z_dim-1);
+}
+
+void Plane::add_normals(int quad_x0, int quad_z0, int quad_x1, int quad_z1) {
+	grid::add_normals(verts, ms.x_dim, ms.z_dim, quad_x0, quad_z0, quad_x1, quad_z1);
+}
+
+void Plane::apply_brush(const util::Brush& brush, int x0, int z0, int x1, int z1) {
+	x0 = std::max(x0, 0); x1 = std::min(x1, ms.x_dim);
+	z0 = std::max(z0, 0); z1 = std::min(z1, ms.z_dim);
+	if (x0 >= x1 || z0 >= z1)
+		return;
+	//upload_dirty only reaches the dynamic buffer.
+	make_dynamic();
+
+	//smoothing has to read unmodified heights, including a border of one.
+	int sx0{ std::max(x0-1, 0) }, sx1{ std::min(x1+1, ms.x_dim) },
+	    sz0{ std::max(z0-1, 0) }, sz1{ std::min(z1+1, ms.z_dim) },
+	    s_dim{ sz1-sz0 };
+	std::vector<float> old_heights;
+	if (brush.kind == util::Brush::SMOOTH)
+		for(int i{sx0}; i != sx1; ++i)
+			for(int j{sz0}; j != sz1; ++j)
+				old_heights.push_back(verts[i*ms.z_dim + j].pos[1]);
+
+	float center_x{ (x0+x1)/2.0f }, half_x{ (x1-x0)/2.0f },
+	      center_z{ (z0+z1)/2.0f }, half_z{ (z1-z0)/2.0f };
 	int offset{ ms.x_dim*ms.z_dim };
-	{
-		int plane_x_dim{ ms.x_dim-1 },
-		    plane_z_dim{ ms.z_dim-1 };
-		for(int i = 0; i != plane_x_dim; ++i)
-			for(int j = 0; j != plane_z_dim; ++j) {
-				int vert_start_indx {i*ms.z_dim + j};
-				
-				//init vertices for triangles.
-				int v1{ vert_start_indx },
-				    v2{ v1+1 },
-				    v3{ vert_start_indx+ms.z_dim },
-				    v4{ v3+1 };
-				
-				int tri_start_indx {(i*plane_z_dim + j) * 12};
-				//first Triangle of "square".
-				indzs[tri_start_indx   ] = v3;
-				indzs[tri_start_indx+ 1] = v2;
-				indzs[tri_start_indx+ 2] = v1;
-				
-				indzs[tri_start_indx+ 3] = v2;
-				indzs[tri_start_indx+ 4] = v3;
-				indzs[tri_start_indx+ 5] = v1;
-				
-				//second Triangle of "square".
-				indzs[tri_start_indx+ 6] = v3+offset;
-				indzs[tri_start_indx+ 7] = v4+offset;
-				indzs[tri_start_indx+ 8] = v2+offset;
-				
-				indzs[tri_start_indx+ 9] = v4+offset;
-				indzs[tri_start_indx+10] = v3+offset;
-				indzs[tri_start_indx+11] = v2+offset;
+	for(int i{x0}; i != x1; ++i)
+		for(int j{z0}; j != z1; ++j) {
+			//cosine-falloff, 1 in the center, 0 just outside the rectangle.
+			float weight{
+				(0.5f + 0.5f*std::cos(bx::kPi*(i+0.5f-center_x)/half_x)) *
+				(0.5f + 0.5f*std::cos(bx::kPi*(j+0.5f-center_z)/half_z)) };
+			float& h{ verts[i*ms.z_dim + j].pos[1] };
+			switch (brush.kind) {
+			case util::Brush::RAISE:
+				h += brush.strength*weight;
+				break;
+			case util::Brush::LOWER:
+				h -= brush.strength*weight;
+				break;
+			case util::Brush::SMOOTH: {
+				float sum{0};
+				int count{0};
+				for(int si{std::max(i-1, sx0)}; si != std::min(i+2, sx1); ++si)
+					for(int sj{std::max(j-1, sz0)}; sj != std::min(j+2, sz1); ++sj, ++count)
+						sum += old_heights[(si-sx0)*s_dim + sj-sz0];
+				h = bx::lerp(h, sum/count, brush.strength*weight);
+				break;
 			}
+			}
+			verts[i*ms.z_dim + j + offset].pos[1] = h;
+		}
+
+	//every quad touching a changed vertex.
+	int qx0{ std::max(x0-1, 0) }, qx1{ std::min(x1, ms.x_dim-1) },
+	    qz0{ std::max(z0-1, 0) }, qz1{ std::min(z1, ms.z_dim-1) };
+	add_normals(qx0, qz0, qx1, qz1);
+
+	//normals of quad (i, j) are stored in (i, j) and (i, j+1) (second copy).
+	x0 = std::min(x0, qx0); x1 = std::max(x1, qx1);
+	z0 = std::min(z0, qz0); z1 = std::max(z1, qz1+1);
+	if (dirty_x0 == dirty_x1) {
+		dirty_x0 = x0; dirty_x1 = x1;
+		dirty_z0 = z0; dirty_z1 = z1;
+	} else {
+		dirty_x0 = std::min(dirty_x0, x0); dirty_x1 = std::max(dirty_x1, x1);
+		dirty_z0 = std::min(dirty_z0, z0); dirty_z1 = std::max(dirty_z1, z1);
 	}
 }
 
-void Plane::add_normals() {
-	for(int i {0}; i != (ms.x_dim-1)*ms.z_dim; ++i) {
-		worldWp::util::add_normal(&verts[i],
-			//pass pos of each Vertex
-			(float*) &verts[i+1],
-			(float*) &verts[i+ms.z_dim]);
-
-		//add normals to "downward-pointing" triangle.
-		int i_offset = ms.x_dim*ms.z_dim+i+1;
-		worldWp::util::add_normal(&verts[i_offset],
-			(float*) &verts[i_offset+ms.z_dim],
-			(float*) &verts[i_offset+ms.z_dim-1]);
+void Plane::upload_dirty() {
+	int offset{ ms.x_dim*ms.z_dim };
+	//one upload per row and copy, rows of the rectangle are not contiguous.
+	for(int i{dirty_x0}; i != dirty_x1; ++i) {
+		updateVBuffer(i*ms.z_dim + dirty_z0, dirty_z1-dirty_z0);
+		updateVBuffer(i*ms.z_dim + dirty_z0 + offset, dirty_z1-dirty_z0);
 	}
+	dirty_x0 = dirty_x1 = 0;
 }
 
 void Plane::add_plane_vertices(const FastNoise& fn, const uint32_t abgr) {
-	//fill verts with values from fn.
-	//indx = i*j at any point in loop.
-	int indx {0};
-	int offset {ms.x_dim*ms.z_dim};
-	for(int i {0}; i != ms.x_dim*ms.res; i+=ms.res)
-		for(int j {0}; j != ms.z_dim*ms.res; j+=ms.res, ++indx)
-			verts[indx+offset] =
-			verts[indx       ] = { float(i-(ms.x_dim-1)*ms.res/2.0),
-			                       util::get_noise_mdfd(indx, i, j, fn, nm),
-			                       float(j-(ms.z_dim-1)*ms.res/2.0), 
-			                       0, 0, 0,
-			                       abgr };
+	float* noise{ get_raw_noise(fn) };
+	grid::fill_vertices(verts, ms, noise, 0, ms.x_dim, abgr);
+	delete[] noise;
 }
 
 void Plane::add_base_vertices(float y_start, const uint32_t abgr) {
@@ -231,13 +263,15 @@ void Plane::add_base_indizes() {
 }
 
 float* Plane::get_raw_noise(const FastNoise& fn) {
-	float* ns {new float[ms.x_dim*ms.z_dim]};
+	return grid::get_raw_noise(ms, fn, nm, tile_octaves);
+}
+
+int Plane::get_grid_sz() const {
+	return ms.x_dim*ms.z_dim;
+}
 
-	int indx {0};
-	for(int i {0}; i != ms.x_dim*ms.res; i+=ms.res)
-		for(int j {0}; j != ms.z_dim*ms.res; j+=ms.res, ++indx)
-			ns[indx] = util::get_noise_mdfd(indx, i, j, fn, nm);
-	return ns;
+const util::PlaneSpecs& Plane::get_specs() const {
+	return ms;
 }
 
 void Plane::for_each_vertex(
@@ -22,16 +22,37 @@ public:
 	  const FastNoise& fn,
 	  const util::NoiseMods& nm,
 	  const uint32_t abgr,
-	  const float base_start );
+	  const float base_start,
+	  //sample cached NoiseTiles with this many octaves instead of fn, 0 for fn.
+	  const int tile_octaves = 0 );
 
 	void for_each_vertex(
 	  const std::function<void(util::PosNormalColorVertex&, int indx)>& fn );
 
+	//noise of fn, or of its NoiseTiles if enabled, for all grid-points.
 	float* get_raw_noise(const FastNoise& fn);
+	//number of grid-points, x_dim*z_dim.
+	int get_grid_sz() const;
+	const util::PlaneSpecs& get_specs() const;
 	void add_normals();
+	//only recompute normals of quads [quad_x0, quad_x1) x [quad_z0, quad_z1).
+	void add_normals(int quad_x0, int quad_z0, int quad_x1, int quad_z1);
+
+	/**
+	 * Apply brush to vertices [x0, x1) x [z0, z1), fading out to the edges of
+	 * the rectangle. Normals are updated around the rectangle only.
+	 * The plane is drawn from its dynamic vertex buffer afterwards.
+	 */
+	void apply_brush(const util::Brush& brush, int x0, int z0, int x1, int z1);
+	//upload all vertices changed by apply_brush since the last call
+	//to the dynamic vertex buffer.
+	void upload_dirty();
 private:
 	util::PlaneSpecs ms;
 	worldWp::util::NoiseMods nm;
+	int tile_octaves;
+	//vertex-rectangle changed since last upload_dirty, empty if x0 == x1.
+	int dirty_x0, dirty_z0, dirty_x1, dirty_z1;
 
 	void add_plane_vertices(const FastNoise& fn, const uint32_t abgr);
 
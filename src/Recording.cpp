@@ -0,0 +1,76 @@
+#include "Recording.hpp"
+#include "NoiseTiles.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+const char recording_magic[4] {'W', 'R', 'E', 'C'};
+const uint32_t recording_version{4};
+
+namespace worldWp {
+
+bool Recording::write(const std::string& path) const {
+	std::ofstream out{path, std::ios::binary};
+	uint32_t seed_count( seeds.size() ),
+	         frame_count( frames.size() );
+	out.write(recording_magic, sizeof(recording_magic));
+	out.write((const char*) &recording_version, sizeof(recording_version));
+	out.write((const char*) &config, sizeof(config));
+	out.write((const char*) &seed_count, sizeof(seed_count));
+	out.write((const char*) seeds.data(), seed_count*sizeof(int32_t));
+	out.write((const char*) &frame_count, sizeof(frame_count));
+	out.write((const char*) frames.data(), frame_count*sizeof(Frame));
+	return out.good();
+}
+
+bool Recording::read(const std::string& path) {
+	std::ifstream in{path, std::ios::binary};
+	in.seekg(0, std::ios::end);
+	std::streamoff file_sz{ in.tellg() };
+	in.seekg(0);
+	//bytes after the read position, to check counts before allocating.
+	auto remaining{ [&]() { return uint64_t(file_sz - in.tellg()); } };
+	char magic[4];
+	uint32_t version, seed_count, frame_count;
+	in.read(magic, sizeof(magic));
+	in.read((char*) &version, sizeof(version));
+	if (!in || std::memcmp(magic, recording_magic, sizeof(magic)) != 0
+	 || version != recording_version) {
+		fprintf(stderr, "%s is not a recording of this version\n", path.c_str());
+		return false;
+	}
+
+	in.read((char*) &config, sizeof(config));
+	in.read((char*) &seed_count, sizeof(seed_count));
+	if (!in)
+		return false;
+	if (config.specs.x_dim < 2 || config.specs.z_dim < 2 || config.specs.res < 1
+	 || config.res_fill < 0 || config.res_fill >= res_fill_count
+	 || config.post_mod < 0 || config.post_mod >= post_mod_count
+	 || config.tran_length <= 0 || config.erosion_iterations < 0
+	 || config.tile_octaves < 0 || config.tile_octaves > NoiseTiles::max_octaves) {
+		fprintf(stderr, "%s has an invalid configuration\n", path.c_str());
+		return false;
+	}
+	if (seed_count == 0) {
+		fprintf(stderr, "%s contains no seeds\n", path.c_str());
+		return false;
+	}
+	if (seed_count*uint64_t(sizeof(int32_t)) > remaining()) {
+		fprintf(stderr, "%s is truncated\n", path.c_str());
+		return false;
+	}
+	seeds.resize(seed_count);
+	in.read((char*) seeds.data(), seeds.size()*sizeof(int32_t));
+	in.read((char*) &frame_count, sizeof(frame_count));
+	if (!in || frame_count*uint64_t(sizeof(Frame)) > remaining()) {
+		fprintf(stderr, "%s is truncated\n", path.c_str());
+		return false;
+	}
+	frames.resize(frame_count);
+	in.read((char*) frames.data(), frames.size()*sizeof(Frame));
+	return bool(in);
+}
+
+};
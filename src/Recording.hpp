@@ -0,0 +1,50 @@
+#ifndef RECORDING_H_
+#define RECORDING_H_
+
+#include "Util.hpp"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace worldWp {
+
+/**
+ * Everything that influences a run of main: configuration, seeds and
+ * per-frame input, plus a checksum of the vertices of each frame to detect
+ * diverging replays.
+ */
+struct Recording {
+	struct Config {
+		util::PlaneSpecs specs;
+		float x_stretch, z_stretch;
+		//indices into the res_fill/post_mod tables of main.
+		int32_t res_fill, post_mod;
+		int32_t tran_length;
+		//erosion-iterations per transition, 0 for none.
+		int32_t erosion_iterations;
+		//octaves of NoiseTiles used instead of FastNoise, 0 for none.
+		int32_t tile_octaves;
+	};
+
+	struct Frame {
+		float mouse_offset[2];
+		uint64_t checksum;
+	};
+
+	//sizes of the res_fill/post_mod tables of main.
+	static constexpr int32_t res_fill_count{2}, post_mod_count{2};
+
+	Config config;
+	//seed of the initial plane, then one per transition.
+	std::vector<int32_t> seeds;
+	std::vector<Frame> frames;
+
+	bool write(const std::string& path) const;
+	//fails on recordings whose config or seeds can't be replayed.
+	bool read(const std::string& path);
+};
+
+};
+
+#endif
@@ -0,0 +1,173 @@
+#include "RenderQueue.hpp"
+
+#include "Model.tpp"
+
+#include <cstring>
+#include <map>
+#include <tuple>
+
+namespace {
+
+//static models merged into one.
+class MergedModel : public worldWp::Model<uint32_t> {
+public:
+	MergedModel(
+	  const std::vector<worldWp::util::PosNormalColorVertex>& verts,
+	  const std::vector<uint32_t>& indzs,
+	  uint64_t indzs_state )
+		: Model{ int(verts.size()), int(indzs.size()), indzs_state } {
+		std::copy(verts.begin(), verts.end(), this->verts);
+		std::copy(indzs.begin(), indzs.end(), this->indzs);
+	}
+};
+
+//strips can't be concatenated without connecting them.
+bool mergeable(uint64_t state) {
+	uint64_t pt{ state & BGFX_STATE_PT_MASK };
+	return pt != BGFX_STATE_PT_TRISTRIP && pt != BGFX_STATE_PT_LINESTRIP;
+}
+
+};
+
+namespace worldWp {
+
+uint16_t RenderQueue::add_transform() {
+	transforms.push_back({1,0,0,0, 0,1,0,0, 0,0,1,0, 0,0,0,1});
+	return transforms.size()-1;
+}
+
+void RenderQueue::set_transform(uint16_t slot, const float mtx[16]) {
+	std::memcpy(transforms[slot].data(), mtx, sizeof(float)*16);
+}
+
+uint16_t RenderQueue::state_id(uint64_t state) {
+	for(size_t i{0}; i != states.size(); ++i)
+		if (states[i] == state)
+			return i;
+	states.push_back(state);
+	return states.size()-1;
+}
+
+uint64_t RenderQueue::make_key(
+  bgfx::ViewId view, bgfx::ProgramHandle program,
+  uint16_t state_id, float depth
+) {
+	//bits of positive floats sort like the floats, keep the upper 24 (without sign).
+	uint32_t depth_bits;
+	std::memcpy(&depth_bits, &depth, sizeof(depth_bits));
+	return uint64_t(view & 0xff) << 56
+	     | uint64_t(program.idx) << 40
+	     | uint64_t(state_id) << 24
+	     | (depth_bits >> 7 & 0xffffff);
+}
+
+void RenderQueue::add(
+  bgfx::ViewId view, bgfx::ProgramHandle program,
+  ModelBase& model, uint16_t transform,
+  uint64_t state, float depth
+) {
+	state |= model.get_indzs_state();
+	items.push_back({make_key(view, program, state_id(state), depth),
+		&model, state, program, view, transform});
+}
+
+void RenderQueue::add_static(
+  bgfx::ViewId view, bgfx::ProgramHandle program,
+  ModelBase& model, uint16_t transform,
+  uint64_t state
+) {
+	state |= model.get_indzs_state();
+	static_items.push_back({make_key(view, program, state_id(state), 0),
+		&model, state, program, view, transform});
+}
+
+void RenderQueue::build_static() {
+	std::map<std::tuple<bgfx::ViewId, uint16_t, uint64_t, uint16_t>, std::vector<Item>> groups;
+	std::vector<Item> unmerged;
+	for(const Item& i : static_items)
+		if (mergeable(i.state))
+			groups[{i.view, i.program.idx, i.state, i.transform}].push_back(i);
+		else
+			unmerged.push_back(i);
+
+	static_items = unmerged;
+	for(const auto& g : groups) {
+		const std::vector<Item>& group{ g.second };
+		if (group.size() == 1) {
+			static_items.push_back(group[0]);
+			continue;
+		}
+
+		std::vector<util::PosNormalColorVertex> verts;
+		std::vector<uint32_t> indzs;
+		for(const Item& i : group)
+			i.model->append_to(verts, indzs);
+		merged.emplace_back(new MergedModel{verts, indzs, group[0].model->get_indzs_state()});
+
+		Item item{ group[0] };
+		item.model = merged.back().get();
+		static_items.push_back(item);
+	}
+}
+
+void RenderQueue::sort() {
+	//static items first, equal keys keep their order.
+	entries.clear();
+	for(size_t i{0}; i != static_items.size(); ++i)
+		entries.push_back({static_items[i].key, uint32_t(i)});
+	for(size_t i{0}; i != items.size(); ++i)
+		entries.push_back({items[i].key, uint32_t(static_items.size()+i)});
+
+	//lsd radix sort of (key, item) pairs, one pass per byte of the key.
+	entries_tmp.resize(entries.size());
+	for(int shift{0}; shift != 64; shift += 8) {
+		size_t counts[256] {0};
+		for(const SortEntry& e : entries)
+			++counts[e.key >> shift & 0xff];
+		//all keys have the same byte, pass would not change anything.
+		if (entries.empty() || counts[entries[0].key >> shift & 0xff] == entries.size())
+			continue;
+
+		size_t offset{0};
+		for(size_t& c : counts) {
+			size_t count{c};
+			c = offset;
+			offset += count;
+		}
+		for(const SortEntry& e : entries)
+			entries_tmp[counts[e.key >> shift & 0xff]++] = e;
+		entries.swap(entries_tmp);
+	}
+
+	sorted_items.clear();
+	for(const SortEntry& e : entries)
+		sorted_items.push_back(e.item < static_items.size()
+			? static_items[e.item]
+			: items[e.item-static_items.size()]);
+}
+
+void RenderQueue::submit() {
+	sort();
+	for(const Item& i : sorted_items)
+		for(int d{0}; d != i.model->get_draw_count(); ++d) {
+			bgfx::setTransform(transforms[i.transform].data());
+			i.model->set_buffers(d);
+			bgfx::setState(i.state);
+			bgfx::submit(i.view, i.program);
+		}
+	clear();
+}
+
+void RenderQueue::clear() {
+	items.clear();
+}
+
+const std::vector<RenderQueue::Item>& RenderQueue::get_items() const {
+	return sorted_items;
+}
+
+int RenderQueue::get_static_count() const {
+	return static_items.size();
+}
+
+};
@@ -0,0 +1,80 @@
+#ifndef RENDER_QUEUE_H_
+#define RENDER_QUEUE_H_
+
+#include "Resources.hpp"
+
+#include "bgfx/bgfx.h"
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace worldWp {
+
+/**
+ * Collects draws, sorts them by view, program, state and depth and submits
+ * them in that order. Static models sharing view, program, state and
+ * transform are merged into one model by build_static.
+ */
+class RenderQueue {
+public:
+	struct Item {
+		uint64_t key;
+		ModelBase *model;
+		uint64_t state;
+		bgfx::ProgramHandle program;
+		bgfx::ViewId view;
+		uint16_t transform;
+	};
+
+	//transforms are referred to by slot, so static models can move.
+	uint16_t add_transform();
+	void set_transform(uint16_t slot, const float mtx[16]);
+
+	//draw model in the next submit only, depth >= 0 sorts near to far.
+	void add(
+	  bgfx::ViewId view, bgfx::ProgramHandle program,
+	  ModelBase& model, uint16_t transform,
+	  uint64_t state = BGFX_STATE_DEFAULT, float depth = 0 );
+	//draw model in every submit after build_static, model must outlive it.
+	void add_static(
+	  bgfx::ViewId view, bgfx::ProgramHandle program,
+	  ModelBase& model, uint16_t transform,
+	  uint64_t state = BGFX_STATE_DEFAULT );
+	//merge static models, call after all add_static.
+	void build_static();
+
+	//sort static and added items by key (radix sort).
+	void sort();
+	//sort, submit and forget items added since the last submit.
+	void submit();
+	//forget items added since the last submit without submitting.
+	void clear();
+
+	const std::vector<Item>& get_items() const;
+	int get_static_count() const;
+
+	static uint64_t make_key(
+	  bgfx::ViewId view, bgfx::ProgramHandle program,
+	  uint16_t state_id, float depth );
+private:
+	std::vector<std::array<float, 16>> transforms;
+	//states seen so far, index is used in keys instead of the full state.
+	std::vector<uint64_t> states;
+	struct SortEntry {
+		uint64_t key;
+		uint32_t item;
+	};
+
+	std::vector<Item> items, sorted_items;
+	std::vector<SortEntry> entries, entries_tmp;
+	std::vector<Item> static_items;
+	std::vector<std::unique_ptr<ModelBase>> merged;
+
+	uint16_t state_id(uint64_t state);
+};
+
+};
+
+#endif
@@ -0,0 +1,165 @@
+#include "Resources.hpp"
+
+#include <algorithm>
+#include <cxxabi.h>
+#include <cstdlib>
+#include <typeinfo>
+
+namespace {
+
+std::string type_name(const worldWp::ModelBase& model) {
+	const char *mangled{ typeid(model).name() };
+	int status;
+	char *demangled{ abi::__cxa_demangle(mangled, nullptr, nullptr, &status) };
+	std::string name{ status == 0 ? demangled : mangled };
+	std::free(demangled);
+	return name;
+}
+
+};
+
+namespace worldWp {
+
+ModelBase::ModelBase()
+	: last_used{ ResourceManager::get().get_frame() } {
+	ResourceManager::get().add(this);
+}
+
+ModelBase::~ModelBase() {
+	ResourceManager::get().remove(this);
+}
+
+bool ModelBase::release_cpu() {
+	return false;
+}
+
+int ModelBase::get_draw_count() const {
+	return 1;
+}
+
+uint64_t ModelBase::get_last_used() const {
+	return last_used;
+}
+
+void ModelBase::touch() {
+	last_used = ResourceManager::get().get_frame();
+}
+
+ResourceManager::ResourceManager()
+	: budget{0},
+	  frame{0} { }
+
+ResourceManager::~ResourceManager() {
+	for(auto& d : deferred)
+		d.second();
+}
+
+ResourceManager& ResourceManager::get() {
+	static ResourceManager manager;
+	return manager;
+}
+
+void ResourceManager::add(ModelBase* model) {
+	models.push_back(model);
+}
+
+void ResourceManager::remove(ModelBase* model) {
+	models.erase(std::remove(models.begin(), models.end(), model), models.end());
+}
+
+std::map<std::string, ResourceManager::Usage> ResourceManager::get_usage() const {
+	std::map<std::string, Usage> usage;
+	for(const ModelBase* m : models) {
+		Usage& u{ usage[type_name(*m)] };
+		++u.count;
+		u.cpu_bytes += m->get_cpu_bytes();
+		u.gpu_bytes += m->get_gpu_bytes();
+	}
+	return usage;
+}
+
+ResourceManager::Usage ResourceManager::get_total() const {
+	Usage total{0, 0, 0};
+	for(const ModelBase* m : models) {
+		++total.count;
+		total.cpu_bytes += m->get_cpu_bytes();
+		total.gpu_bytes += m->get_gpu_bytes();
+	}
+	return total;
+}
+
+void ResourceManager::print_usage(FILE* out) const {
+	fprintf(out, "%-24s %6s %12s %12s\n", "model", "count", "cpu[KiB]", "gpu[KiB]");
+	for(const auto& u : get_usage())
+		fprintf(out, "%-24s %6d %12.1f %12.1f\n", u.first.c_str(), u.second.count,
+			u.second.cpu_bytes/1024.0, u.second.gpu_bytes/1024.0);
+	Usage total{ get_total() };
+	fprintf(out, "%-24s %6d %12.1f %12.1f\n", "total", total.count,
+		total.cpu_bytes/1024.0, total.gpu_bytes/1024.0);
+}
+
+void ResourceManager::set_budget(size_t bytes) {
+	budget = bytes;
+}
+
+void ResourceManager::set_over_budget_report(const std::function<void(size_t over)>& fn) {
+	over_budget_report = fn;
+}
+
+uint64_t ResourceManager::get_frame() const {
+	return frame;
+}
+
+void ResourceManager::next_frame() {
+	++frame;
+	//bgfx reads makeRef-memory within two frames.
+	auto released{ std::partition(deferred.begin(), deferred.end(),
+		[this](const std::pair<uint64_t, std::function<void()>>& d) {
+			return d.first+2 > frame;
+		}) };
+	for(auto d{released}; d != deferred.end(); ++d)
+		d->second();
+	deferred.erase(released, deferred.end());
+	if (budget == 0)
+		return;
+
+	Usage total{ get_total() };
+	size_t used{ total.cpu_bytes + total.gpu_bytes };
+	if (used <= budget)
+		return;
+
+	//least recently used first.
+	std::vector<ModelBase*> by_age{ models };
+	std::sort(by_age.begin(), by_age.end(), [](const ModelBase* a, const ModelBase* b) {
+		return a->get_last_used() < b->get_last_used();
+	});
+	//gpu-buffers first, they are cheaper to restore.
+	for(ModelBase* m : by_age) {
+		//this and all following models were used in the last frame.
+		if (used <= budget || m->get_last_used()+1 >= frame)
+			break;
+		used -= m->get_gpu_bytes();
+		m->release_gpu();
+	}
+	for(ModelBase* m : by_age) {
+		if (used <= budget)
+			break;
+		size_t cpu_bytes{ m->get_cpu_bytes() };
+		if (m->release_cpu())
+			used -= cpu_bytes;
+	}
+
+	if (used > budget && over_budget_report)
+		over_budget_report(used-budget);
+}
+
+void ResourceManager::defer_free(const std::function<void()>& free_fn) {
+	deferred.push_back({frame, free_fn});
+}
+
+void ResourceManager::release_gpu() {
+	for(ModelBase* m : models)
+		m->release_gpu();
+}
+
+};
@@ -0,0 +1,117 @@
+#ifndef RESOURCES_H_
+#define RESOURCES_H_
+
+#include "Util.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace worldWp {
+
+/**
+ * Non-template part of Model, lets ResourceManager account for and evict
+ * models of any index type.
+ */
+class ModelBase {
+public:
+	ModelBase();
+	virtual ~ModelBase();
+	ModelBase(const ModelBase&) = delete;
+	ModelBase& operator=(const ModelBase&) = delete;
+
+	virtual size_t get_cpu_bytes() const = 0;
+	virtual size_t get_gpu_bytes() const = 0;
+	//destroy all bgfx-buffers, they are recreated by the next get*Handle.
+	virtual void release_gpu() = 0;
+	/**
+	 * Free vertices and indices if the model can generate them again, which
+	 * it does when a buffer has to be created or it is merged. Existing
+	 * bgfx-buffers are kept, so it can still be drawn.
+	 * @return false if it can't, nothing is freed then.
+	 */
+	virtual bool release_cpu();
+
+	virtual uint64_t get_indzs_state() const = 0;
+	//number of submits needed to draw the model, 1 unless it is split.
+	virtual int get_draw_count() const;
+	//set vertex- and index-buffer for the next submit of draw draw_indx.
+	virtual void set_buffers(int draw_indx) = 0;
+	//append vertices and indices (offset by verts.size()) for merging.
+	virtual void append_to(
+	  std::vector<util::PosNormalColorVertex>& verts,
+	  std::vector<uint32_t>& indzs ) = 0;
+	uint64_t get_last_used() const;
+protected:
+	//mark as used in the current frame.
+	void touch();
+private:
+	uint64_t last_used;
+};
+
+/**
+ * Knows all live models, reports their memory and keeps cpu+gpu memory
+ * within a budget: first gpu-buffers of the least recently used models are
+ * released, then cpu-arrays of all models that can regenerate them.
+ * Gpu-buffers of models drawn in the last frame are kept, releasing them
+ * would only re-upload them right away.
+ */
+class ResourceManager {
+public:
+	struct Usage {
+		int count;
+		size_t cpu_bytes,
+		       gpu_bytes;
+	};
+
+	static ResourceManager& get();
+
+	void add(ModelBase* model);
+	void remove(ModelBase* model);
+
+	//usage per model-type.
+	std::map<std::string, Usage> get_usage() const;
+	Usage get_total() const;
+	void print_usage(FILE* out) const;
+
+	//budget in bytes, 0 for none.
+	void set_budget(size_t bytes);
+	/**
+	 * Called with the bytes still over budget after releasing all it can.
+	 * Only a report, what remains is in use and can't be regenerated.
+	 */
+	void set_over_budget_report(const std::function<void(size_t over)>& fn);
+	/**
+	 * Start a new frame and enforce the budget. Has to be called before any
+	 * get*Handle of the frame, handles from earlier frames may be invalid.
+	 */
+	void next_frame();
+	uint64_t get_frame() const;
+
+	//release gpu-buffers of all models, call before bgfx::shutdown.
+	void release_gpu();
+	/**
+	 * Call free_fn once bgfx can't read the memory anymore, ie. two frames
+	 * later, for arrays handed to bgfx::makeRef. Still pending ones are
+	 * called when the manager is destroyed.
+	 */
+	void defer_free(const std::function<void()>& free_fn);
+private:
+	ResourceManager();
+	~ResourceManager();
+
+	std::vector<ModelBase*> models;
+	size_t budget;
+	uint64_t frame;
+	std::function<void(size_t over)> over_budget_report;
+	//frame of defer_free and the function.
+	std::vector<std::pair<uint64_t, std::function<void()>>> deferred;
+};
+
+};
+
+#endif
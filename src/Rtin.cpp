@@ -0,0 +1,117 @@
+#include "Rtin.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace worldWp {
+
+Rtin::Rtin(const util::PlaneSpecs& ms, const float* heights)
+	: ms{ ms },
+	  grid_sz{2} {
+	while (grid_sz-1 < std::max(ms.x_dim, ms.z_dim)-1)
+		grid_sz = (grid_sz-1)*2+1;
+	errors.assign(grid_sz*grid_sz, 0);
+
+	//heights outside the real grid are clamped to its border.
+	auto height{ [&](int x, int y) {
+		return heights[std::min(x, ms.x_dim-1)*ms.z_dim + std::min(y, ms.z_dim-1)];
+	}};
+	auto straddles{ [&](int a, int b, int c, int border) {
+		return std::min({a, b, c}) < border && std::max({a, b, c}) > border;
+	}};
+
+	int tile_sz{grid_sz-1},
+	    tri_count{tile_sz*tile_sz*2 - 2},
+	    parent_count{tri_count - tile_sz*tile_sz};
+
+	//go from smallest to largest triangles so child errors are done first.
+	for(int i{tri_count-1}; i >= 0; --i) {
+		//walk down from the root triangles to find the corners of i.
+		int id{i+2},
+		    ax{0}, ay{0}, bx{0}, by{0}, cx{0}, cy{0};
+		if (id & 1)
+			bx = by = cx = tile_sz;
+		else
+			ax = ay = cy = tile_sz;
+		while ((id >>= 1) > 1) {
+			int mx{(ax+bx) >> 1},
+			    my{(ay+by) >> 1};
+			if (id & 1) {
+				bx = ax; by = ay;
+				ax = cx; ay = cy;
+			} else {
+				ax = bx; ay = by;
+				bx = cx; by = cy;
+			}
+			cx = mx; cy = my;
+		}
+
+		int mx{(ax+bx) >> 1},
+		    my{(ay+by) >> 1};
+		cx = mx+my-ay;
+		cy = my+ax-mx;
+
+		float middle_error{0};
+		//force splits until no triangle crosses the border of the real grid.
+		if (straddles(ax, bx, cx, ms.x_dim-1) || straddles(ay, by, cy, ms.z_dim-1))
+			middle_error = std::numeric_limits<float>::infinity();
+		else {
+			//check every grid point covered by the triangle, not only the
+			//midpoint, so max_error is a real bound.
+			int d{ (bx-ax)*(cy-ay) - (cx-ax)*(by-ay) },
+			    sign{ d > 0 ? 1 : -1 };
+			float ha{ height(ax, ay) },
+			      hb{ height(bx, by) },
+			      hc{ height(cx, cy) };
+			for(int x{std::min({ax, bx, cx})}; x <= std::max({ax, bx, cx}); ++x)
+				for(int y{std::min({ay, by, cy})}; y <= std::max({ay, by, cy}); ++y) {
+					int wa{ (bx-x)*(cy-y) - (cx-x)*(by-y) },
+					    wb{ (cx-x)*(ay-y) - (ax-x)*(cy-y) },
+					    wc{ d-wa-wb };
+					if (wa*sign < 0 || wb*sign < 0 || wc*sign < 0)
+						continue;
+					float interpolated{ (wa*ha + wb*hb + wc*hc)/d };
+					middle_error = std::max(middle_error, std::abs(interpolated - height(x, y)));
+				}
+		}
+
+		float& err{ errors[my*grid_sz + mx] };
+		err = std::max(err, middle_error);
+		if (i < parent_count) {
+			int left_child{ ((ay+cy) >> 1)*grid_sz + ((ax+cx) >> 1) },
+			    right_child{ ((by+cy) >> 1)*grid_sz + ((bx+cx) >> 1) };
+			err = std::max({err, errors[left_child], errors[right_child]});
+		}
+	}
+}
+
+std::vector<uint32_t> Rtin::triangles(float max_error) const {
+	std::vector<uint32_t> out;
+	int max{grid_sz-1};
+	add_triangles(out, max_error, 0, 0, max, max, max, 0);
+	add_triangles(out, max_error, max, max, 0, 0, 0, max);
+	return out;
+}
+
+void Rtin::add_triangles(
+  std::vector<uint32_t>& out, float max_error,
+  int ax, int ay, int bx, int by, int cx, int cy
+) const {
+	//triangle lies completely outside of the real grid.
+	if (std::min({ax, bx, cx}) >= ms.x_dim-1 || std::min({ay, by, cy}) >= ms.z_dim-1)
+		return;
+
+	int mx{(ax+bx) >> 1},
+	    my{(ay+by) >> 1};
+	if (std::abs(ax-cx) + std::abs(ay-cy) > 1 && errors[my*grid_sz + mx] > max_error) {
+		add_triangles(out, max_error, cx, cy, ax, ay, mx, my);
+		add_triangles(out, max_error, bx, by, cx, cy, mx, my);
+	} else {
+		out.push_back(ax*ms.z_dim + ay);
+		out.push_back(bx*ms.z_dim + by);
+		out.push_back(cx*ms.z_dim + cy);
+	}
+}
+
+};
@@ -0,0 +1,40 @@
+#ifndef RTIN_H_
+#define RTIN_H_
+
+#include "Util.hpp"
+
+#include <cstdint>
+#include <vector>
+
+namespace worldWp {
+
+/**
+ * Right-triangulated irregular network over a height grid.
+ * The grid is embedded into the smallest square of size 2^k+1 that contains
+ * it, triangles crossing the border of the real grid are always split, so the
+ * mesh covers exactly the grid.
+ */
+class Rtin {
+public:
+	Rtin(const util::PlaneSpecs& ms, const float* heights);
+
+	/**
+	 * Triangles whose height differs from the grid by at most max_error.
+	 * @return three grid-indices (x*z_dim + z) per triangle.
+	 */
+	std::vector<uint32_t> triangles(float max_error) const;
+private:
+	util::PlaneSpecs ms;
+	//side length of the square grid, 2^k+1.
+	int grid_sz;
+	//max error of each triangle, stored at the middle of its hypotenuse.
+	std::vector<float> errors;
+
+	void add_triangles(
+	  std::vector<uint32_t>& out, float max_error,
+	  int ax, int ay, int bx, int by, int cx, int cy ) const;
+};
+
+};
+
+#endif
@@ -0,0 +1,29 @@
+#ifndef SHADER_ARCHIVE_H_
+#define SHADER_ARCHIVE_H_
+
+#include <cstdint>
+
+namespace worldWp {
+
+/**
+ * Layout of a packed shader archive (see shaderpack):
+ * ArchiveHeader, header.count ArchiveEntries, then the shader binaries.
+ */
+struct ArchiveHeader {
+	char magic[4];
+	uint32_t count;
+};
+
+struct ArchiveEntry {
+	//shader name without extension, eg. "vs_simple".
+	char name[56];
+	//offset from start of archive.
+	uint32_t offset,
+	         size;
+};
+
+const char archive_magic[4] {'W', 'S', 'P', 'K'};
+
+};
+
+#endif
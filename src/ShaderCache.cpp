@@ -0,0 +1,144 @@
+#include "ShaderCache.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace worldWp {
+
+ShaderCache::ShaderCache(const std::string& dir)
+	: dir{ dir } { }
+
+ShaderCache::~ShaderCache() {
+	wait_pending();
+	for(const Mapping& m : mappings)
+		munmap(m.addr, m.size);
+}
+
+bool ShaderCache::map_file(const std::string& path, Binary& out) {
+	int fd{ open(path.c_str(), O_RDONLY) };
+	if (fd == -1) {
+		fprintf(stderr, "Could not open shader %s\n", path.c_str());
+		return false;
+	}
+	struct stat st;
+	if (fstat(fd, &st) == -1 || st.st_size == 0) {
+		close(fd);
+		return false;
+	}
+	void *addr{ mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE | MAP_POPULATE, fd, 0) };
+	close(fd);
+	if (addr == MAP_FAILED)
+		return false;
+
+	std::lock_guard<std::mutex> lock{mutex};
+	mappings.push_back({addr, size_t(st.st_size)});
+	out = {static_cast<const uint8_t*>(addr), size_t(st.st_size)};
+	return true;
+}
+
+void ShaderCache::preload(const std::vector<std::string>& names) {
+	pending.push_back(std::async(std::launch::async, [this, names]() {
+		for(const std::string& name : names) {
+			Binary bin;
+			if (!map_file(dir + name + ".bin", bin))
+				continue;
+			std::lock_guard<std::mutex> lock{mutex};
+			//archive-entries take precedence.
+			binaries.insert({name, bin});
+		}
+	}));
+}
+
+void ShaderCache::preload_archive(const std::string& path) {
+	pending.push_back(std::async(std::launch::async, [this, path]() {
+		Binary archive;
+		if (!map_file(path, archive))
+			return;
+
+		const ArchiveHeader *header{ reinterpret_cast<const ArchiveHeader*>(archive.data) };
+		if (archive.size < sizeof(ArchiveHeader)
+		 || std::memcmp(header->magic, archive_magic, sizeof(archive_magic)) != 0
+		 || archive.size < sizeof(ArchiveHeader) + header->count*sizeof(ArchiveEntry)) {
+			fprintf(stderr, "Invalid shader archive %s\n", path.c_str());
+			return;
+		}
+
+		const ArchiveEntry *entries{ reinterpret_cast<const ArchiveEntry*>(header+1) };
+		std::lock_guard<std::mutex> lock{mutex};
+		for(uint32_t i{0}; i != header->count; ++i) {
+			const ArchiveEntry& e{ entries[i] };
+			if (size_t(e.offset) + e.size > archive.size)
+				continue;
+			std::string name(e.name, strnlen(e.name, sizeof(e.name)));
+			binaries[name] = {archive.data + e.offset, e.size};
+		}
+	}));
+}
+
+void ShaderCache::wait_pending() {
+	for(std::future<void>& f : pending)
+		f.wait();
+	pending.clear();
+}
+
+bgfx::ShaderHandle ShaderCache::get_shader(const std::string& name) {
+	auto shader{ shaders.find(name) };
+	if (shader != shaders.end())
+		return shader->second;
+
+	wait_pending();
+	auto bin{ binaries.find(name) };
+	if (bin == binaries.end()) {
+		//not preloaded, map it now.
+		Binary b;
+		if (!map_file(dir + name + ".bin", b))
+			return BGFX_INVALID_HANDLE;
+		bin = binaries.insert({name, b}).first;
+	}
+
+	//bgfx expects a terminating '\0' after the binary.
+	const bgfx::Memory* mem{ bgfx::alloc(bin->second.size+1) };
+	std::memcpy(mem->data, bin->second.data, bin->second.size);
+	mem->data[mem->size-1] = '\0';
+
+	bgfx::ShaderHandle handle{ bgfx::createShader(mem) };
+	bgfx::setName(handle, name.c_str());
+	shaders[name] = handle;
+	return handle;
+}
+
+bgfx::ProgramHandle ShaderCache::get_program(const std::string& vs_name, const std::string& fs_name) {
+	auto program{ programs.find({vs_name, fs_name}) };
+	if (program != programs.end())
+		return program->second;
+
+	bgfx::ShaderHandle vs{ get_shader(vs_name) },
+	                   fs{ get_shader(fs_name) };
+	bgfx::ProgramHandle handle BGFX_INVALID_HANDLE;
+	//shaders may be shared between programs, dont let bgfx destroy them.
+	if (bgfx::isValid(vs) && bgfx::isValid(fs))
+		handle = bgfx::createProgram(vs, fs, false);
+	//not cached, a later call may find the shaders.
+	if (!bgfx::isValid(handle)) {
+		fprintf(stderr, "Could not create program from %s and %s\n", vs_name.c_str(), fs_name.c_str());
+		return handle;
+	}
+	programs[{vs_name, fs_name}] = handle;
+	return handle;
+}
+
+void ShaderCache::destroy() {
+	for(auto& p : programs)
+		bgfx::destroy(p.second);
+	for(auto& s : shaders)
+		if (bgfx::isValid(s.second))
+			bgfx::destroy(s.second);
+	programs.clear();
+	shaders.clear();
+}
+
+};
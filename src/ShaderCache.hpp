@@ -0,0 +1,64 @@
+#ifndef SHADER_CACHE_H_
+#define SHADER_CACHE_H_
+
+#include "bgfx/bgfx.h"
+#include "ShaderArchive.hpp"
+
+#include <cstdint>
+#include <future>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace worldWp {
+
+/**
+ * Memory-maps compiled shaders on a background thread and hands out shared
+ * shader- and program-handles. get_* have to be called from the thread that
+ * uses bgfx, they wait for pending preloads.
+ */
+class ShaderCache {
+public:
+	//dir is prepended to shader names, eg. "build/shaders/".
+	ShaderCache(const std::string& dir);
+	~ShaderCache();
+
+	//map dir/<name>.bin for each name in the background.
+	void preload(const std::vector<std::string>& names);
+	//map an archive in the background, its shaders take precedence over files.
+	void preload_archive(const std::string& path);
+
+	bgfx::ShaderHandle get_shader(const std::string& name);
+	bgfx::ProgramHandle get_program(const std::string& vs_name, const std::string& fs_name);
+
+	//destroy all handles, call before bgfx::shutdown.
+	void destroy();
+private:
+	struct Mapping {
+		void *addr;
+		size_t size;
+	};
+
+	struct Binary {
+		const uint8_t *data;
+		size_t size;
+	};
+
+	std::string dir;
+	std::mutex mutex;
+	std::vector<std::future<void>> pending;
+	std::vector<Mapping> mappings;
+	//name -> mapped binary, filled by preloads.
+	std::map<std::string, Binary> binaries;
+	std::map<std::string, bgfx::ShaderHandle> shaders;
+	std::map<std::pair<std::string, std::string>, bgfx::ProgramHandle> programs;
+
+	//map path into memory and fault all pages in, false on failure.
+	bool map_file(const std::string& path, Binary& out);
+	void wait_pending();
+};
+
+};
+
+#endif
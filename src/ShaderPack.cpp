@@ -0,0 +1,57 @@
+#include "ShaderArchive.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+/**
+ * Pack compiled shaders into one archive for ShaderCache::preload_archive.
+ * Usage: shaderpack <archive> <shader.bin>...
+ * Entries are named after the files without directory and extension.
+ */
+int main(int argc, char** argv) {
+	if (argc < 3) {
+		fprintf(stderr, "Usage: %s <archive> <shader.bin>...\n", argv[0]);
+		return 1;
+	}
+
+	std::vector<worldWp::ArchiveEntry> entries;
+	std::vector<std::vector<char>> binaries;
+	uint32_t offset( sizeof(worldWp::ArchiveHeader) + (argc-2)*sizeof(worldWp::ArchiveEntry) );
+	for(int i{2}; i != argc; ++i) {
+		std::ifstream file{argv[i], std::ios::binary};
+		if (!file.is_open()) {
+			fprintf(stderr, "Could not open %s\n", argv[i]);
+			return 1;
+		}
+		binaries.emplace_back(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+
+		std::string name{argv[i]};
+		name = name.substr(name.find_last_of('/')+1);
+		name = name.substr(0, name.find_last_of('.'));
+
+		worldWp::ArchiveEntry e{};
+		if (name.size() >= sizeof(e.name)) {
+			fprintf(stderr, "Shader name too long: %s\n", name.c_str());
+			return 1;
+		}
+		std::strncpy(e.name, name.c_str(), sizeof(e.name));
+		e.offset = offset;
+		e.size = binaries.back().size();
+		entries.push_back(e);
+		offset += e.size;
+	}
+
+	std::ofstream out{argv[1], std::ios::binary};
+	worldWp::ArchiveHeader header;
+	std::memcpy(header.magic, worldWp::archive_magic, sizeof(header.magic));
+	header.count = entries.size();
+	out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	out.write(reinterpret_cast<const char*>(entries.data()), entries.size()*sizeof(worldWp::ArchiveEntry));
+	for(const std::vector<char>& b : binaries)
+		out.write(b.data(), b.size());
+	return out.good() ? 0 : 1;
+}
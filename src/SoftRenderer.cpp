@@ -0,0 +1,498 @@
+#include "SoftRenderer.hpp"
+
+#include "TiledPlane.hpp"
+
+#include "bx/math.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+//pixels per side of a tile.
+const int tile_sz{64};
+//triangles of a draw are split into at most max_slices slices of at least
+//slice_tris triangles, each slice has its own bins so setup needs no locks.
+//Independent of the number of threads, so images are too.
+const int max_slices{64};
+const int slice_tris{1024};
+
+//bands of fs_lines.
+const float band_b0{.3},
+            band_b1{.6};
+
+namespace {
+
+uint8_t to_byte(float f) {
+	return uint8_t(std::min(1.0f, std::max(0.0f, f))*255 + .5f);
+}
+
+//fs_simple for a flat normal and color.
+uint32_t shade_simple(const float* normal, uint32_t rgba) {
+	if (normal[0] == 0 && normal[1] == 0 && normal[2] == 0)
+		return rgba;
+	//light comes from (0, 1, 0), facing away gives black instead of NaN.
+	//pow(pow(c, 2.2)*ndotl, 1/2.2) is c*pow(ndotl, 1/2.2).
+	float light{ std::pow(std::max(0.0f, normal[1]), 1/2.2f) };
+	uint32_t out{0xff000000};
+	for(int c{0}; c != 3; ++c)
+		out |= uint32_t(to_byte(((rgba >> 8*c) & 0xff)/255.0f*light)) << 8*c;
+	return out;
+}
+
+//fs_lines for model-space z.
+inline uint32_t shade_lines(float z) {
+	float m{ z - 4*std::floor(z/4) },
+	      clr{ m <= band_b0 ? (band_b0-m)/band_b0 :
+	           m <= band_b1 ? (m-(band_b1-band_b0))/band_b0 : 1 };
+	uint32_t gray( std::min(1.0f, std::max(0.0f, clr))*255 + .5f );
+	return 0xff000000 | gray << 16 | gray << 8 | gray;
+}
+
+void put_be32(std::vector<uint8_t>& out, uint32_t val) {
+	for(int shift{24}; shift >= 0; shift -= 8)
+		out.push_back(val >> shift);
+}
+
+uint32_t crc32(const uint8_t* data, size_t size) {
+	static uint32_t table[256];
+	if (table[1] == 0)
+		for(uint32_t i{0}; i != 256; ++i) {
+			uint32_t c{i};
+			for(int k{0}; k != 8; ++k)
+				c = c & 1 ? 0xedb88320 ^ (c >> 1) : c >> 1;
+			table[i] = c;
+		}
+	uint32_t crc{0xffffffff};
+	for(size_t i{0}; i != size; ++i)
+		crc = table[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+	return crc ^ 0xffffffff;
+}
+
+//png with uncompressed (stored) deflate-blocks, no zlib needed.
+std::vector<uint8_t> encode_png(const std::vector<uint8_t>& rgb, int width, int height) {
+	std::vector<uint8_t> png{0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+	auto chunk{ [&png](const char* type, const std::vector<uint8_t>& data) {
+		put_be32(png, data.size());
+		size_t start{ png.size() };
+		png.insert(png.end(), type, type+4);
+		png.insert(png.end(), data.begin(), data.end());
+		put_be32(png, crc32(&png[start], png.size()-start));
+	}};
+
+	std::vector<uint8_t> ihdr;
+	put_be32(ihdr, width);
+	put_be32(ihdr, height);
+	//8 bit rgb, default compression, filter and no interlace.
+	ihdr.insert(ihdr.end(), {8, 2, 0, 0, 0});
+	chunk("IHDR", ihdr);
+
+	//rows with filter-type 0.
+	std::vector<uint8_t> raw;
+	raw.reserve(height*(1 + width*3));
+	for(int y{0}; y != height; ++y) {
+		raw.push_back(0);
+		raw.insert(raw.end(), rgb.begin() + y*width*3, rgb.begin() + (y+1)*width*3);
+	}
+
+	std::vector<uint8_t> idat{0x78, 0x01};
+	uint32_t adler_a{1}, adler_b{0};
+	for(size_t pos{0}; pos == 0 || pos != raw.size();) {
+		uint16_t len( std::min<size_t>(raw.size()-pos, 0xffff) );
+		bool last{ pos+len == raw.size() };
+		idat.insert(idat.end(), {uint8_t(last), uint8_t(len), uint8_t(len >> 8),
+		                         uint8_t(~len), uint8_t(~len >> 8)});
+		idat.insert(idat.end(), raw.begin()+pos, raw.begin()+pos+len);
+		for(size_t i{pos}; i != pos+len; ++i) {
+			adler_a = (adler_a + raw[i]) % 65521;
+			adler_b = (adler_b + adler_a) % 65521;
+		}
+		pos += len;
+		if (last)
+			break;
+	}
+	put_be32(idat, adler_b << 16 | adler_a);
+	chunk("IDAT", idat);
+	chunk("IEND", {});
+	return png;
+}
+
+};
+
+namespace worldWp {
+
+SoftRenderer::SoftRenderer(int width, int height)
+	: width{ width },
+	  height{ height },
+	  tiles_x{ (width + tile_sz-1) / tile_sz },
+	  tiles_y{ (height + tile_sz-1) / tile_sz },
+	  triangle_count{0},
+	  pixels(width*height),
+	  depth(width*height),
+	  slices(max_slices) {
+	for(Slice& slice : slices)
+		slice.bins.resize(tiles_x*tiles_y);
+	//identity until set_view_transform.
+	std::fill(view_proj, view_proj+16, 0.0f);
+	for(int i{0}; i != 4; ++i)
+		view_proj[i*5] = 1;
+	clear(0x000000ff);
+}
+
+void SoftRenderer::clear(uint32_t rgba) {
+	//rgba to the byte-order of vertex-colors.
+	uint32_t abgr{ (rgba >> 24) | (rgba >> 8 & 0xff00) | (rgba << 8 & 0xff0000) | (rgba << 24) };
+	std::fill(pixels.begin(), pixels.end(), abgr);
+	std::fill(depth.begin(), depth.end(), 1.0f);
+	triangle_count = 0;
+}
+
+void SoftRenderer::set_view_transform(const float* view, const float* proj) {
+	bx::mtxMul(view_proj, view, proj);
+}
+
+void SoftRenderer::draw(
+  const TiledPlane& model,
+  const float* mtx,
+  Shading shading,
+  uint64_t state
+) {
+	for(const TiledPlane::Tile& t : model.get_tiles())
+		draw(model.get_verts() + t.vert_start, model.get_indzs() + t.indx_start,
+		     t.indx_sz, t.vert_sz, mtx, shading, state | model.get_indzs_state());
+}
+
+void SoftRenderer::draw(
+  const util::PosNormalColorVertex* verts,
+  const uint16_t* indzs, int indzs_sz, int vert_sz,
+  const float* mtx, Shading shading, uint64_t state
+) {
+	draw_indexed(verts, indzs, indzs_sz, vert_sz, mtx, shading, state);
+}
+
+void SoftRenderer::draw(
+  const util::PosNormalColorVertex* verts,
+  const uint32_t* indzs, int indzs_sz, int vert_sz,
+  const float* mtx, Shading shading, uint64_t state
+) {
+	draw_indexed(verts, indzs, indzs_sz, vert_sz, mtx, shading, state);
+}
+
+template<typename T>
+void SoftRenderer::draw_indexed(
+  const util::PosNormalColorVertex* verts,
+  const T* indzs, int indzs_sz, int vert_sz,
+  const float* mtx, Shading shading, uint64_t state
+) {
+	transform(verts, vert_sz, mtx);
+
+	uint64_t pt{ state & BGFX_STATE_PT_MASK };
+	if (pt == BGFX_STATE_PT_POINTS)
+		return;
+	if (pt == BGFX_STATE_PT_LINES || pt == BGFX_STATE_PT_LINESTRIP) {
+		//lines are few, one thread is enough.
+		int step{ pt == BGFX_STATE_PT_LINES ? 2 : 1 };
+		for(int i{0}; i+1 < indzs_sz; i += step)
+			draw_line(verts, indzs[i], indzs[i+1], shading);
+		return;
+	}
+
+	bool strip{ pt == BGFX_STATE_PT_TRISTRIP };
+	int tri_sz{ strip ? std::max(indzs_sz-2, 0) : indzs_sz/3 },
+	    slice_cnt{ std::max(1, std::min(max_slices, tri_sz/slice_tris)) };
+	util::parallel_for(slice_cnt, [&](int begin, int end) {
+		for(int s{begin}; s != end; ++s) {
+			Slice& slice{ slices[s] };
+			slice.setups.clear();
+			for(std::vector<uint32_t>& bin : slice.bins)
+				bin.clear();
+
+			for(int t( int64_t(tri_sz)*s/slice_cnt ); t != int64_t(tri_sz)*(s+1)/slice_cnt; ++t)
+				if (strip)
+					//every second triangle of a strip is flipped to keep the winding.
+					setup_triangle(slice, verts, indzs[t + (t&1)], indzs[t+1 - (t&1)],
+					               indzs[t+2], shading, state);
+				else
+					setup_triangle(slice, verts, indzs[3*t], indzs[3*t+1],
+					               indzs[3*t+2], shading, state);
+		}
+	});
+
+	for(int s{0}; s != slice_cnt; ++s)
+		triangle_count += slices[s].setups.size();
+	rasterize(slice_cnt);
+}
+
+void SoftRenderer::transform(
+  const util::PosNormalColorVertex* verts,
+  int vert_sz,
+  const float* mtx
+) {
+	float mvp[16];
+	bx::mtxMul(mvp, mtx, view_proj);
+
+	clip_verts.resize(vert_sz);
+	util::parallel_for(vert_sz, [&](int begin, int end) {
+		for(int i{begin}; i != end; ++i) {
+			const float* p{ verts[i].pos };
+			float out[4];
+			for(int c{0}; c != 4; ++c)
+				out[c] = p[0]*mvp[c] + p[1]*mvp[4+c] + p[2]*mvp[8+c] + mvp[12+c];
+			clip_verts[i] = {out[0], out[1], out[2], out[3], p[2]};
+		}
+	});
+}
+
+void SoftRenderer::setup_triangle(
+  Slice& slice,
+  const util::PosNormalColorVertex* verts,
+  uint32_t i0, uint32_t i1, uint32_t i2,
+  Shading shading, uint64_t state
+) {
+	//flat attributes come from the provoking (last) vertex.
+	const util::PosNormalColorVertex& pv{ verts[i2] };
+	bool no_normal{ pv.normal[0] == 0 && pv.normal[1] == 0 && pv.normal[2] == 0 };
+	uint32_t color{ shading == SIMPLE ? shade_simple(pv.normal, pv.rgba) : 0xff000000 };
+	bool flat{ shading == SIMPLE || no_normal };
+
+	const ClipVert* in[3]{ &clip_verts[i0], &clip_verts[i1], &clip_verts[i2] };
+	if (in[0]->z >= 0 && in[1]->z >= 0 && in[2]->z >= 0) {
+		add_triangle(slice, *in[0], *in[1], *in[2], color, flat, state);
+		return;
+	}
+
+	//clip against the near plane z = 0, leaves up to 4 vertices.
+	ClipVert poly[4];
+	int n{0};
+	for(int k{0}; k != 3; ++k) {
+		const ClipVert &a{ *in[k] },
+		               &b{ *in[(k+1)%3] };
+		if (a.z >= 0)
+			poly[n++] = a;
+		if ((a.z >= 0) != (b.z >= 0)) {
+			float t{ a.z/(a.z - b.z) };
+			poly[n++] = { a.x + t*(b.x-a.x), a.y + t*(b.y-a.y), a.z + t*(b.z-a.z),
+			              a.w + t*(b.w-a.w), a.pos_z + t*(b.pos_z-a.pos_z) };
+		}
+	}
+	for(int k{1}; k+1 < n; ++k)
+		add_triangle(slice, poly[0], poly[k], poly[k+1], color, flat, state);
+}
+
+void SoftRenderer::add_triangle(
+  Slice& slice,
+  const ClipVert& a, const ClipVert& b, const ClipVert& c,
+  uint32_t color, bool flat, uint64_t state
+) {
+	//to pixels, y pointing down.
+	const ClipVert* v[3]{ &a, &b, &c };
+	float x[3], y[3], z[3], inv_w[3], pos_z[3];
+	for(int k{0}; k != 3; ++k) {
+		inv_w[k] = 1/v[k]->w;
+		x[k] = (v[k]->x*inv_w[k]*.5f + .5f)*width;
+		y[k] = (.5f - v[k]->y*inv_w[k]*.5f)*height;
+		z[k] = v[k]->z*inv_w[k];
+		pos_z[k] = v[k]->pos_z*inv_w[k];
+	}
+
+	float area{ (x[1]-x[0])*(y[2]-y[0]) - (x[2]-x[0])*(y[1]-y[0]) };
+	//also catches NaN.
+	if (!(area > 0 || area < 0))
+		return;
+	//with y pointing down, positive area is clockwise.
+	uint64_t cull{ state & BGFX_STATE_CULL_MASK };
+	if ((area > 0 && cull == BGFX_STATE_CULL_CW)
+	 || (area < 0 && cull == BGFX_STATE_CULL_CCW))
+		return;
+
+	Setup t;
+	t.x0 = int(std::max(0.0f, std::floor(std::min({x[0], x[1], x[2]}))));
+	t.y0 = int(std::max(0.0f, std::floor(std::min({y[0], y[1], y[2]}))));
+	t.x1 = int(std::min(float(width), std::ceil(std::max({x[0], x[1], x[2]}))));
+	t.y1 = int(std::min(float(height), std::ceil(std::max({y[0], y[1], y[2]}))));
+	if (t.x0 >= t.x1 || t.y0 >= t.y1)
+		return;
+
+	float sign{ area > 0 ? -1.0f : 1.0f };
+	for(int k{0}; k != 3; ++k) {
+		int k1{ (k+1)%3 };
+		t.edge[k][0] = sign*(y[k1] - y[k]);
+		t.edge[k][1] = -sign*(x[k1] - x[k]);
+		t.edge[k][2] = -(t.edge[k][0]*x[k] + t.edge[k][1]*y[k]);
+	}
+	//f = a*x + b*y + c through the values at the three vertices.
+	auto plane{ [&](const float* f, float* out) {
+		out[0] = ((f[1]-f[0])*(y[2]-y[0]) - (f[2]-f[0])*(y[1]-y[0])) / area;
+		out[1] = ((f[2]-f[0])*(x[1]-x[0]) - (f[1]-f[0])*(x[2]-x[0])) / area;
+		out[2] = f[0] - out[0]*x[0] - out[1]*y[0];
+	}};
+	plane(z, t.z);
+	plane(inv_w, t.inv_w);
+	plane(pos_z, t.pos_z);
+	t.color = color;
+	t.flat = flat;
+
+	uint32_t indx( slice.setups.size() );
+	slice.setups.push_back(t);
+	for(int ty{t.y0/tile_sz}; ty <= (t.y1-1)/tile_sz; ++ty)
+		for(int tx{t.x0/tile_sz}; tx <= (t.x1-1)/tile_sz; ++tx)
+			slice.bins[ty*tiles_x + tx].push_back(indx);
+}
+
+void SoftRenderer::rasterize(int slice_cnt) {
+	util::parallel_for(tiles_x*tiles_y, [&](int begin, int end) {
+		for(int tile{begin}; tile != end; ++tile) {
+			int x0{ tile%tiles_x*tile_sz },
+			    y0{ tile/tiles_x*tile_sz },
+			    x1{ std::min(x0+tile_sz, width) },
+			    y1{ std::min(y0+tile_sz, height) };
+			//slices in order, so triangles are drawn in submission-order.
+			for(int s{0}; s != slice_cnt; ++s)
+				for(uint32_t indx : slices[s].bins[tile]) {
+					const Setup& t{ slices[s].setups[indx] };
+					raster_triangle(t, std::max(x0, t.x0), std::max(y0, t.y0),
+					                   std::min(x1, t.x1), std::min(y1, t.y1));
+				}
+		}
+	});
+}
+
+void SoftRenderer::raster_triangle(const Setup& t, int x0, int y0, int x1, int y1) {
+	//inner loops are branchless, so they can be vectorized.
+	for(int y{y0}; y < y1; ++y) {
+		float py{ y + .5f },
+		      r0{ t.edge[0][1]*py + t.edge[0][2] },
+		      r1{ t.edge[1][1]*py + t.edge[1][2] },
+		      r2{ t.edge[2][1]*py + t.edge[2][2] },
+		      rz{ t.z[1]*py + t.z[2] };
+		float* depth_row{ &depth[y*width] };
+		uint32_t* color_row{ &pixels[y*width] };
+
+		if (t.flat)
+			for(int x{x0}; x < x1; ++x) {
+				float px{ x + .5f },
+				      z{ t.z[0]*px + rz };
+				bool pass( (t.edge[0][0]*px + r0 >= 0) & (t.edge[1][0]*px + r1 >= 0)
+				         & (t.edge[2][0]*px + r2 >= 0) & (z < depth_row[x]) );
+				depth_row[x] = pass ? z : depth_row[x];
+				color_row[x] = pass ? t.color : color_row[x];
+			}
+		else {
+			float rw{ t.inv_w[1]*py + t.inv_w[2] },
+			      rp{ t.pos_z[1]*py + t.pos_z[2] };
+			for(int x{x0}; x < x1; ++x) {
+				float px{ x + .5f },
+				      z{ t.z[0]*px + rz };
+				bool pass( (t.edge[0][0]*px + r0 >= 0) & (t.edge[1][0]*px + r1 >= 0)
+				         & (t.edge[2][0]*px + r2 >= 0) & (z < depth_row[x]) );
+				//perspective-correct v_position.z.
+				uint32_t color{ shade_lines((t.pos_z[0]*px + rp)/(t.inv_w[0]*px + rw)) };
+				depth_row[x] = pass ? z : depth_row[x];
+				color_row[x] = pass ? color : color_row[x];
+			}
+		}
+	}
+}
+
+void SoftRenderer::draw_line(
+  const util::PosNormalColorVertex* verts,
+  uint32_t i0, uint32_t i1, Shading shading
+) {
+	ClipVert v[2]{ clip_verts[i0], clip_verts[i1] };
+	if (v[0].z < 0 && v[1].z < 0)
+		return;
+	//clip against the near plane.
+	for(int k{0}; k != 2; ++k)
+		if (v[k].z < 0) {
+			const ClipVert &a{ v[k] }, &b{ v[1-k] };
+			float t{ a.z/(a.z - b.z) };
+			v[k] = { a.x + t*(b.x-a.x), a.y + t*(b.y-a.y), 0,
+			         a.w + t*(b.w-a.w), a.pos_z + t*(b.pos_z-a.pos_z) };
+		}
+
+	const util::PosNormalColorVertex& pv{ verts[i1] };
+	bool flat{ shading == SIMPLE
+	        || (pv.normal[0] == 0 && pv.normal[1] == 0 && pv.normal[2] == 0) };
+	uint32_t color{ shading == SIMPLE ? shade_simple(pv.normal, pv.rgba) : 0xff000000 };
+
+	//x, y, z, 1/w and pos_z/w are linear along the line in pixels.
+	float p[2][5];
+	for(int k{0}; k != 2; ++k) {
+		float inv_w{ 1/v[k].w };
+		p[k][0] = (v[k].x*inv_w*.5f + .5f)*width;
+		p[k][1] = (.5f - v[k].y*inv_w*.5f)*height;
+		p[k][2] = v[k].z*inv_w;
+		p[k][3] = inv_w;
+		p[k][4] = v[k].pos_z*inv_w;
+	}
+
+	//clip to the image, [t0, t1] is the visible part.
+	float t0{0}, t1{1};
+	for(int c{0}; c != 2; ++c) {
+		float d{ p[1][c] - p[0][c] },
+		      size( c == 0 ? width : height );
+		for(float bound : {0.0f, size}) {
+			if (d == 0) {
+				if ((bound == 0 && p[0][c] < 0) || (bound != 0 && p[0][c] > size))
+					return;
+				continue;
+			}
+			float t{ (bound - p[0][c])/d };
+			//entering if moving towards the inside.
+			if ((bound == 0) == (d > 0))
+				t0 = std::max(t0, t);
+			else
+				t1 = std::min(t1, t);
+		}
+	}
+	if (t0 > t1)
+		return;
+
+	float dx{ p[1][0] - p[0][0] },
+	      dy{ p[1][1] - p[0][1] };
+	int steps( std::ceil(std::max(std::abs(dx), std::abs(dy))*(t1-t0)) );
+	for(int s{0}; s <= steps; ++s) {
+		float t{ t0 + (steps == 0 ? 0 : (t1-t0)*s/steps) },
+		      l[5];
+		for(int c{0}; c != 5; ++c)
+			l[c] = p[0][c] + t*(p[1][c] - p[0][c]);
+		int x( l[0] ), y( l[1] );
+		if (x < 0 || x >= width || y < 0 || y >= height)
+			continue;
+		int indx{ y*width + x };
+		if (l[2] < depth[indx]) {
+			depth[indx] = l[2];
+			pixels[indx] = flat ? color : shade_lines(l[4]/l[3]);
+		}
+	}
+}
+
+bool SoftRenderer::write(const std::string& path) const {
+	std::vector<uint8_t> rgb(width*height*3);
+	for(int i{0}; i != width*height; ++i)
+		for(int c{0}; c != 3; ++c)
+			rgb[i*3 + c] = pixels[i] >> 8*c;
+
+	FILE* out{ std::fopen(path.c_str(), "wb") };
+	if (!out)
+		return false;
+	bool ppm{ path.size() >= 4 && path.compare(path.size()-4, 4, ".ppm") == 0 },
+	     ok;
+	if (ppm) {
+		std::fprintf(out, "P6\n%d %d\n255\n", width, height);
+		ok = std::fwrite(rgb.data(), 1, rgb.size(), out) == rgb.size();
+	} else {
+		std::vector<uint8_t> png{ encode_png(rgb, width, height) };
+		ok = std::fwrite(png.data(), 1, png.size(), out) == png.size();
+	}
+	return std::fclose(out) == 0 && ok;
+}
+
+const uint32_t* SoftRenderer::get_pixels() const {
+	return pixels.data();
+}
+
+size_t SoftRenderer::get_triangle_count() const {
+	return triangle_count;
+}
+
+};
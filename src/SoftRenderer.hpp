@@ -0,0 +1,136 @@
+#ifndef SOFT_RENDERER_H_
+#define SOFT_RENDERER_H_
+
+#include "Model.tpp"
+#include "Util.hpp"
+
+#include "bgfx/bgfx.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace worldWp {
+
+class TiledPlane;
+
+/**
+ * Renders Models into an image on the cpu, eg. for previews on machines
+ * without gpu. Reproduces fs_simple and fs_lines, depth-test is always
+ * less with depth-write.
+ * Triangles are binned into the tiles of the image they touch, tiles are
+ * rasterized in parallel.
+ */
+class SoftRenderer {
+public:
+	//fragment-shader to reproduce.
+	enum Shading {
+		SIMPLE, LINES
+	};
+
+	SoftRenderer(int width, int height);
+
+	//rgba like bgfx::setViewClear, depth is cleared to 1.
+	void clear(uint32_t rgba);
+	//proj has to be made with homogeneousDepth false, ie. depth in [0, 1].
+	void set_view_transform(const float* view, const float* proj);
+
+	/**
+	 * Draw model transformed by mtx. The primitive-type comes from the
+	 * indzs_state of model, culling from state like in bgfx.
+	 */
+	template<typename T>
+	void draw(
+	  const Model<T>& model,
+	  const float* mtx,
+	  Shading shading,
+	  uint64_t state = BGFX_STATE_DEFAULT ) {
+		draw(model.get_verts(), model.get_indzs(), model.get_indzs_sz(),
+		     model.get_vert_sz(), mtx, shading, state | model.get_indzs_state());
+	}
+	//indices of TiledPlane are relative to their tile, draws tile by tile.
+	void draw(
+	  const TiledPlane& model,
+	  const float* mtx,
+	  Shading shading,
+	  uint64_t state = BGFX_STATE_DEFAULT );
+
+	//png or ppm, depending on the extension of path.
+	bool write(const std::string& path) const;
+	//width*height pixels, abgr like vertex-colors, top row first.
+	const uint32_t* get_pixels() const;
+	//triangles rasterized since the last clear, after culling and clipping.
+	size_t get_triangle_count() const;
+private:
+	//vertex after transformation.
+	struct ClipVert {
+		float x, y, z, w;
+		//model-space z, v_position.z of fs_lines.
+		float pos_z;
+	};
+
+	//triangle ready for rasterization, all planes are in pixels.
+	struct Setup {
+		//a*x + b*y + c of each edge, >= 0 inside.
+		float edge[3][3];
+		//planes of depth, 1/w and pos_z/w.
+		float z[3], inv_w[3], pos_z[3];
+		//bounding box of covered pixels, end exclusive.
+		int x0, y0, x1, y1;
+		//color of the whole triangle if flat, else fs_lines per pixel.
+		uint32_t color;
+		bool flat;
+	};
+
+	//a contiguous part of the triangles of a draw.
+	struct Slice {
+		std::vector<Setup> setups;
+		//indices into setups, per tile.
+		std::vector<std::vector<uint32_t>> bins;
+	};
+
+	int width, height,
+	    tiles_x, tiles_y;
+	float view_proj[16];
+	size_t triangle_count;
+	std::vector<uint32_t> pixels;
+	std::vector<float> depth;
+	std::vector<ClipVert> clip_verts;
+	std::vector<Slice> slices;
+
+	void draw(
+	  const util::PosNormalColorVertex* verts,
+	  const uint16_t* indzs, int indzs_sz, int vert_sz,
+	  const float* mtx, Shading shading, uint64_t state );
+	void draw(
+	  const util::PosNormalColorVertex* verts,
+	  const uint32_t* indzs, int indzs_sz, int vert_sz,
+	  const float* mtx, Shading shading, uint64_t state );
+	template<typename T>
+	void draw_indexed(
+	  const util::PosNormalColorVertex* verts,
+	  const T* indzs, int indzs_sz, int vert_sz,
+	  const float* mtx, Shading shading, uint64_t state );
+
+	void transform(const util::PosNormalColorVertex* verts, int vert_sz, const float* mtx);
+	//clip against the near plane, cull and bin.
+	void setup_triangle(
+	  Slice& slice,
+	  const util::PosNormalColorVertex* verts,
+	  uint32_t i0, uint32_t i1, uint32_t i2,
+	  Shading shading, uint64_t state );
+	void add_triangle(
+	  Slice& slice,
+	  const ClipVert& a, const ClipVert& b, const ClipVert& c,
+	  uint32_t color, bool flat, uint64_t state );
+	void rasterize(int slice_cnt);
+	//rasterize t within pixels [x0, x1) x [y0, y1).
+	void raster_triangle(const Setup& t, int x0, int y0, int x1, int y1);
+	void draw_line(
+	  const util::PosNormalColorVertex* verts,
+	  uint32_t i0, uint32_t i1, Shading shading );
+};
+
+};
+
+#endif
@@ -0,0 +1,129 @@
+#include "TiledPlane.hpp"
+
+#include "Grid.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+
+namespace {
+
+std::vector<worldWp::TiledPlane::Tile> make_tiles(const worldWp::util::PlaneSpecs& ms) {
+	std::vector<worldWp::TiledPlane::Tile> tiles;
+	int max_rows{ worldWp::TiledPlane::max_tile_rows(ms.z_dim) };
+	assert(max_rows >= 2);
+
+	uint32_t vert_start{0},
+	         indx_start{0};
+	//neighbouring tiles share one row, the quads between them have to
+	//belong to one of the tiles.
+	for(int row{0}; row < ms.x_dim-1; row += max_rows-1) {
+		int rows{ std::min(max_rows, ms.x_dim-row) };
+		uint32_t vert_sz( rows*ms.z_dim*2 ),
+		         indx_sz( worldWp::grid::indzs_count(rows, ms.z_dim) );
+		tiles.push_back({row, rows, vert_start, vert_sz, indx_start, indx_sz});
+		vert_start += vert_sz;
+		indx_start += indx_sz;
+	}
+	return tiles;
+}
+
+int tiles_vert_sz(const std::vector<worldWp::TiledPlane::Tile>& tiles) {
+	return tiles.back().vert_start + tiles.back().vert_sz;
+}
+
+int tiles_indx_sz(const std::vector<worldWp::TiledPlane::Tile>& tiles) {
+	return tiles.back().indx_start + tiles.back().indx_sz;
+}
+
+};
+
+namespace worldWp {
+
+TiledPlane::TiledPlane(
+  const util::PlaneSpecs& ms,
+  const FastNoise& fn,
+  const util::NoiseMods& nm,
+  const uint32_t abgr,
+  const int tile_octaves
+)
+	: Model{
+		tiles_vert_sz(make_tiles(ms)),
+		tiles_indx_sz(make_tiles(ms)),
+		0x0000000000000000 },
+	  ms{ ms },
+	  nm{ nm },
+	  tile_octaves{ tile_octaves },
+	  tiles{ make_tiles(ms) } {
+	float* noise{ get_raw_noise(fn) };
+	for(const Tile& t : tiles) {
+		grid::fill_vertices(verts+t.vert_start, ms, noise, t.row_start, t.rows, abgr);
+		grid::fill_indzs(indzs+t.indx_start, t.rows, ms.z_dim);
+	}
+	delete[] noise;
+	add_normals();
+}
+
+int TiledPlane::max_tile_rows(int z_dim) {
+	//every vertex exists twice for normals.
+	return std::numeric_limits<uint16_t>::max() / (z_dim*2);
+}
+
+void TiledPlane::add_normals() {
+	for(const Tile& t : tiles)
+		grid::add_normals(verts+t.vert_start, t.rows, ms.z_dim,
+			0, 0, t.rows-1, ms.z_dim-1);
+}
+
+float* TiledPlane::get_raw_noise(const FastNoise& fn) {
+	return grid::get_raw_noise(ms, fn, nm, tile_octaves);
+}
+
+void TiledPlane::for_each_vertex(
+  const std::function<void(util::PosNormalColorVertex&, int indx)>& fn
+) {
+	for(const Tile& t : tiles) {
+		util::PosNormalColorVertex *tile_verts{ verts+t.vert_start };
+		int tile_sz{ t.rows*ms.z_dim },
+		    grid_start{ t.row_start*ms.z_dim };
+		for(int i{0}; i != tile_sz; ++i) {
+			fn(tile_verts[i], grid_start+i);
+			fn(tile_verts[i+tile_sz], grid_start+i);
+		}
+	}
+}
+
+const std::vector<TiledPlane::Tile>& TiledPlane::get_tiles() const {
+	return tiles;
+}
+
+int TiledPlane::get_draw_count() const {
+	return tiles.size();
+}
+
+void TiledPlane::set_buffers(int draw_indx) {
+	set_tile_buffers(draw_indx, getVBufferHandle(), getIBufferHandle());
+}
+
+void TiledPlane::append_to(
+  std::vector<util::PosNormalColorVertex>& verts,
+  std::vector<uint32_t>& indzs
+) {
+	uint32_t offset( verts.size() );
+	verts.insert(verts.end(), this->verts, this->verts+get_vert_sz());
+	for(const Tile& t : tiles)
+		for(uint32_t i{t.indx_start}; i != t.indx_start+t.indx_sz; ++i)
+			indzs.push_back(this->indzs[i] + t.vert_start + offset);
+}
+
+void TiledPlane::set_tile_buffers(
+  int tile_indx,
+  bgfx::VertexBufferHandle vbh,
+  bgfx::IndexBufferHandle ibh
+) const {
+	const Tile& t{ tiles[tile_indx] };
+	bgfx::setVertexBuffer(0, vbh, t.vert_start, t.vert_sz);
+	bgfx::setIndexBuffer(ibh, t.indx_start, t.indx_sz);
+}
+
+};
@@ -0,0 +1,77 @@
+#ifndef TILED_PLANE_H_
+#define TILED_PLANE_H_
+
+#include "Util.hpp"
+#include "Model.tpp"
+
+#include "FastNoise.h"
+#include "bgfx/bgfx.h"
+
+#include <functional>
+#include <vector>
+
+namespace worldWp {
+
+/**
+ * Same surface as Plane (without base, same vertices and noise), but split into bands of rows that
+ * each hold at most 65535 vertices, so all indices fit into uint16_t.
+ * All tiles live in one vertex- and one index-buffer, each tile is drawn
+ * with its own vertex offset (see set_tile_buffers), so drawing takes one
+ * submit per tile (see get_draw_count).
+ * Not used by main yet: it has no base, and Transition, erosion and
+ * brushes only work on Plane.
+ */
+class TiledPlane : public Model<uint16_t> {
+public:
+	struct Tile {
+		//first grid-row and number of grid-rows in this tile.
+		int row_start, rows;
+		uint32_t vert_start, vert_sz,
+		         indx_start, indx_sz;
+	};
+
+	TiledPlane(
+	  const util::PlaneSpecs& ms,
+	  const FastNoise& fn,
+	  const util::NoiseMods& nm,
+	  const uint32_t abgr,
+	  //like for Plane, 0 for fn.
+	  const int tile_octaves = 0 );
+
+	/**
+	 * Same as Plane::for_each_vertex, indx is the index into the whole grid.
+	 * Rows on tile-borders exist in both tiles, fn is called for each copy.
+	 */
+	void for_each_vertex(
+	  const std::function<void(util::PosNormalColorVertex&, int indx)>& fn );
+
+	//same as Plane::get_raw_noise.
+	float* get_raw_noise(const FastNoise& fn);
+	void add_normals();
+
+	const std::vector<Tile>& get_tiles() const;
+	//one draw per tile.
+	int get_draw_count() const override;
+	void set_buffers(int draw_indx) override;
+	//indices are offset by the start of their tile, too.
+	void append_to(
+	  std::vector<util::PosNormalColorVertex>& verts,
+	  std::vector<uint32_t>& indzs ) override;
+	//set vertex- and index-buffer for drawing tile tile_indx.
+	void set_tile_buffers(
+	  int tile_indx,
+	  bgfx::VertexBufferHandle vbh,
+	  bgfx::IndexBufferHandle ibh ) const;
+
+	//maximum number of grid-rows per tile for a grid with z_dim columns.
+	static int max_tile_rows(int z_dim);
+private:
+	util::PlaneSpecs ms;
+	util::NoiseMods nm;
+	int tile_octaves;
+	std::vector<Tile> tiles;
+};
+
+};
+
+#endif
@@ -0,0 +1,82 @@
+#include "Transition.hpp"
+
+#include <algorithm>
+
+namespace worldWp {
+
+Transition::Transition(Plane& plane, int length)
+	: plane{ plane },
+	  length{ length },
+	  frame_ctr{-1},
+	  erosion_iterations{0} { }
+
+void Transition::next_frame() {
+	++frame_ctr;
+	if (frame_ctr == length)
+		frame_ctr = 0;
+}
+
+bool Transition::starting() const {
+	return frame_ctr == 0;
+}
+
+void Transition::set_target(const FastNoise& fn) {
+	float* new_noise = plane.get_raw_noise(fn);
+	retarget(new_noise);
+	if (erosion_iterations > 0)
+		erosion.reset(new Erosion{plane.get_specs(), new_noise, erosion_params, erosion_iterations});
+	delete[] new_noise;
+}
+
+void Transition::set_erosion(int iterations, const Erosion::Params& p) {
+	erosion_iterations = iterations;
+	erosion_params = p;
+	if (iterations <= 0)
+		return;
+
+	//the current heights were never a target, erode them right away.
+	std::vector<float> heights(plane.get_grid_sz());
+	plane.for_each_vertex([&heights](util::PosNormalColorVertex& v, int i) {
+		heights[i] = v.pos[1];
+	});
+	Erosion current{plane.get_specs(), heights.data(), p, iterations};
+	current.step(iterations);
+	heights = current.get_heights();
+	plane.for_each_vertex([&heights](util::PosNormalColorVertex& v, int i) {
+		v.pos[1] = heights[i];
+	});
+	plane.add_normals();
+}
+
+void Transition::retarget(const float* target) {
+	//remaining steps, including the one of this frame.
+	float steps = length - std::max(frame_ctr, 0);
+	offset_noise.resize(plane.get_grid_sz());
+	plane.for_each_vertex(
+		[this, target, steps](util::PosNormalColorVertex& v, int i) {
+			//offset_nose is difference between new and old noise.
+			offset_noise[i] = (target[i] - v.pos[1])*(1.0/steps);
+	});
+}
+
+void Transition::step() {
+	if (erosion) {
+		//finish within the first half of the transition.
+		int half{ std::max(length/2, 1) };
+		if (erosion->step((erosion_iterations + half-1) / half)) {
+			retarget(erosion->get_heights().data());
+			erosion.reset();
+		}
+	}
+
+	plane.for_each_vertex(
+		[this](util::PosNormalColorVertex& v, int i) {
+			v.pos[1]+=offset_noise[i];
+	});
+}
+
+int Transition::get_length() const {
+	return length;
+}
+
+};
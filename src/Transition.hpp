@@ -0,0 +1,54 @@
+#ifndef TRANSITION_H_
+#define TRANSITION_H_
+
+#include "Plane.hpp"
+#include "Erosion.hpp"
+
+#include "FastNoise.h"
+
+#include <memory>
+#include <vector>
+
+namespace worldWp {
+
+/**
+ * Morphs a Plane towards new noise over a fixed number of frames, then
+ * starts over with the next noise.
+ */
+class Transition {
+public:
+	Transition(Plane& plane, int length);
+
+	//advance the frame counter, call once at the start of each frame.
+	void next_frame();
+	//true if a new target has to be set this frame.
+	bool starting() const;
+	//morph towards the noise of fn during the next length frames.
+	void set_target(const FastNoise& fn);
+	/**
+	 * Erode the current heights of plane at once, and every following target
+	 * for iterations iterations, spread over the first half of the
+	 * transition. Until erosion is done the plane morphs towards the
+	 * uneroded target. 0 disables erosion.
+	 */
+	void set_erosion(int iterations, const Erosion::Params& p = {});
+	//move the heights of plane one frame towards the target.
+	void step();
+	int get_length() const;
+private:
+	Plane& plane;
+	int length, frame_ctr;
+	//height-change per frame.
+	std::vector<float> offset_noise;
+
+	int erosion_iterations;
+	Erosion::Params erosion_params;
+	//erosion of the current target, if not done yet.
+	std::unique_ptr<Erosion> erosion;
+	//set offsets so that plane reaches target at the end of the transition.
+	void retarget(const float* target);
+};
+
+};
+
+#endif
@@ -2,12 +2,139 @@
 
 #include "bgfx/bgfx.h"
 #include "bx/math.h"
+#include <algorithm>
+#include <condition_variable>
 #include <cstdio>
-#include <fstream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+
+/**
+ * Threads of parallel_for, started once and reused by every call. One call
+ * runs at a time, the calling thread works on chunks too.
+ */
+class WorkerPool {
+public:
+	static WorkerPool& get() {
+		static WorkerPool pool;
+		return pool;
+	}
+
+	~WorkerPool() {
+		stop_workers();
+	}
+
+	//waits for a running call, then restarts the workers.
+	void set_thread_count(int count) {
+		std::lock_guard<std::mutex> run_lock{run_mutex};
+		stop_workers();
+		start_workers(count);
+	}
+
+	void run(int n, const std::function<void(int begin, int end)>& fn) {
+		if (n <= 0)
+			return;
+		int thread_cnt{ std::min(int(workers.size())+1, n) },
+		    chunk{ (n+thread_cnt-1) / thread_cnt };
+		//nested calls would wait for themselves, single chunks need no threads.
+		if (in_job || chunk == n) {
+			fn(0, n);
+			return;
+		}
+
+		std::lock_guard<std::mutex> run_lock{run_mutex};
+		std::unique_lock<std::mutex> lock{mutex};
+		job = &fn;
+		job_n = n;
+		chunk_sz = chunk;
+		chunk_cnt = (n+chunk-1) / chunk;
+		next_chunk = 0;
+		chunks_left = chunk_cnt;
+		++generation;
+		wake.notify_all();
+
+		in_job = true;
+		run_chunks(lock);
+		done.wait(lock, [this]() { return chunks_left == 0; });
+		in_job = false;
+	}
+private:
+	std::vector<std::thread> workers;
+	//run_mutex serializes calls, mutex guards the job.
+	std::mutex run_mutex, mutex;
+	std::condition_variable wake, done;
+	const std::function<void(int begin, int end)>* job;
+	int job_n, chunk_sz, chunk_cnt, next_chunk, chunks_left;
+	uint64_t generation;
+	bool stop;
+	//true on workers and on the caller while it runs chunks.
+	static thread_local bool in_job;
+
+	WorkerPool()
+		: job{nullptr},
+		  job_n{0}, chunk_sz{0}, chunk_cnt{0}, next_chunk{0}, chunks_left{0},
+		  generation{0},
+		  stop{false} {
+		start_workers(0);
+	}
+
+	//count threads including the caller, 0 for one per hardware thread.
+	void start_workers(int count) {
+		if (count <= 0)
+			count = std::max(1, int(std::thread::hardware_concurrency()));
+		stop = false;
+		for(int i{1}; i < count; ++i)
+			workers.emplace_back(&WorkerPool::work, this);
+	}
+
+	void stop_workers() {
+		{
+			std::lock_guard<std::mutex> lock{mutex};
+			stop = true;
+		}
+		wake.notify_all();
+		for(std::thread& t : workers)
+			t.join();
+		workers.clear();
+	}
+
+	void work() {
+		in_job = true;
+		std::unique_lock<std::mutex> lock{mutex};
+		uint64_t seen{generation};
+		while (true) {
+			wake.wait(lock, [&]() { return stop || generation != seen; });
+			if (stop)
+				return;
+			seen = generation;
+			run_chunks(lock);
+		}
+	}
+
+	//take chunks of the current job until none are left, lock is held between.
+	void run_chunks(std::unique_lock<std::mutex>& lock) {
+		while (next_chunk < chunk_cnt) {
+			int c{ next_chunk++ };
+			lock.unlock();
+			(*job)(c*chunk_sz, std::min((c+1)*chunk_sz, job_n));
+			lock.lock();
+			if (--chunks_left == 0)
+				done.notify_all();
+		}
+	}
+};
+
+thread_local bool WorkerPool::in_job{false};
+
+};
 
 namespace worldWp {
 namespace util {
 
+bgfx::VertexLayout PosNormalColorVertex::layout;
+
 void PosNormalColorVertex::init() {
     layout
         .begin()
@@ -67,25 +194,6 @@ NoiseMods::~NoiseMods() {
 	delete[] res_stretch;
 }
 
-bgfx::ShaderHandle load_shader(const char *name) {
-    char *data = new char[2048];
-    std::ifstream file;
-    size_t fileSize;
-    file.open(name);
-    if(file.is_open()) {
-        file.seekg(0, std::ios::end);
-        fileSize = file.tellg();
-        file.seekg(0, std::ios::beg);
-        file.read(data, fileSize);
-        file.close();
-    }
-    const bgfx::Memory* mem = bgfx::copy(data,fileSize+1);
-    mem->data[mem->size-1] = '\0';
-    bgfx::ShaderHandle handle = bgfx::createShader(mem);
-    bgfx::setName(handle, name);
-    return handle;
-}
-
 void glfw_errorCallback(int error, const char *description) {
 	fprintf(stderr, "GLFW error %d: %s\n", error, description);
 }
@@ -116,5 +224,21 @@ float get_noise_mdfd(int res_indx, float x, float z, FastNoise fn, const NoiseMo
 	return nm.post_mod(nm.res_stretch[res_indx]*fn.GetNoise(nm.x_stretch*x, nm.z_stretch*z));
 }
 
+uint64_t checksum(const void* data, size_t size) {
+	const uint8_t *bytes{ static_cast<const uint8_t*>(data) };
+	uint64_t hash{0xcbf29ce484222325};
+	for(size_t i{0}; i != size; ++i)
+		hash = (hash ^ bytes[i]) * 0x100000001b3;
+	return hash;
+}
+
+void parallel_for(int n, const std::function<void(int begin, int end)>& fn) {
+	WorkerPool::get().run(n, fn);
+}
+
+void set_thread_count(int count) {
+	WorkerPool::get().set_thread_count(count);
+}
+
 };
 };
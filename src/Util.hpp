@@ -34,6 +34,17 @@ struct NoiseMods {
 	~NoiseMods();
 };
 
+struct Brush {
+	enum Kind {
+		RAISE, LOWER, SMOOTH
+	};
+
+	Kind kind;
+	//height added at the center for RAISE/LOWER,
+	//blend towards the local average (0..1) for SMOOTH.
+	float strength;
+};
+
 struct PosNormalColorVertex {
     float pos[3];
 	float normal[3];
@@ -43,11 +54,18 @@ struct PosNormalColorVertex {
     static bgfx::VertexLayout layout;
 };
     
-bgfx::ShaderHandle load_shader(const char *name);
 void glfw_errorCallback(int error, const char *description);
 void add_normal(PosNormalColorVertex *vert_vec, const float* vec_a, const float* vec_b);
 bx::Vec3 triangle_normal(bx::Vec3 t, bx::Vec3 a, bx::Vec3 b);
 float get_noise_mdfd(int res_indx, float x, float z, FastNoise fn, const NoiseMods& nm);
+//64-bit FNV-1a hash of size bytes at data.
+uint64_t checksum(const void* data, size_t size);
+//split [0, n) into one chunk per thread, call fn(begin, end) for each.
+//Threads are started once and reused, calls from inside fn run serially.
+void parallel_for(int n, const std::function<void(int begin, int end)>& fn);
+//threads of parallel_for including the caller, 0 for one per hardware
+//thread (the default). Not from inside fn.
+void set_thread_count(int count);
 
 };
 };
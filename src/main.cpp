@@ -2,22 +2,37 @@
 #include "Plane.hpp"
 #include "Frame.hpp"
 #include "DiamondFrame.hpp"
+#include "HeightPublisher.hpp"
+#include "NoiseTiles.hpp"
+#include "ShaderCache.hpp"
+#include "Recording.hpp"
+#include "Resources.hpp"
+#include "RenderQueue.hpp"
+#include "SoftRenderer.hpp"
+#include "Transition.hpp"
 
 #include "bgfx/bgfx.h"
 #include "bgfx/defines.h"
 #include "bgfx/platform.h"
 #include "bx/math.h"
 
+#include <algorithm>
+#include <chrono>
 #include <cmath>
+#include <cstdio>
 #include <cstdlib>
+#include <cstring>
 #include <functional>
 #include <iostream>
+#include <memory>
+#include <random>
 #include <GLFW/glfw3.h>
 
 #define GLFW_EXPOSE_NATIVE_X11
 #include <GLFW/glfw3native.h>
 
-const worldWp::util::PlaneSpecs specs {90, 90, 1};
+//not const, replays use the specs of the recording.
+worldWp::util::PlaneSpecs specs {90, 90, 1};
 
 const std::function<float(int x, int z)> edge_smooth_mod { [](int x, int z){
 		return std::sin(float(x)/(specs.x_dim-1)*bx::kPi)
@@ -36,7 +51,144 @@ const std::function<float(float noise)> no_mod { [](float noise){
 	return noise;
 }};
 
-bgfx::VertexLayout worldWp::util::PosNormalColorVertex::layout;
+//NoiseMods-functions by index, so recordings can refer to them.
+const std::function<float(int x, int z)> res_fills[] {edge_smooth_mod, res_fill_none};
+const std::function<float(float noise)> post_mods[] {no_mod, no_valley_mod};
+static_assert(sizeof(res_fills)/sizeof(res_fills[0]) == worldWp::Recording::res_fill_count
+           && sizeof(post_mods)/sizeof(post_mods[0]) == worldWp::Recording::post_mod_count,
+              "Recording has to know the sizes of the tables");
+
+worldWp::util::NoiseMods make_noise_mods(const worldWp::Recording::Config& conf) {
+	return {conf.x_stretch, conf.z_stretch, conf.specs,
+	        res_fills[conf.res_fill], post_mods[conf.post_mod]};
+}
+
+uint64_t plane_checksum(const worldWp::Plane& plane) {
+	return worldWp::util::checksum(plane.get_verts(),
+		plane.get_vert_sz()*sizeof(worldWp::util::PosNormalColorVertex));
+}
+
+/**
+ * Write heights and normals of plane to the next slot of publisher.
+ * Normals come from central differences of the heights (one-sided at the
+ * edges), every grid-point gets one.
+ */
+void publish_heights(worldWp::HeightPublisher& publisher, const worldWp::Plane& plane) {
+	worldWp::HeightPublisher::Slot slot{ publisher.begin_write() };
+	const worldWp::util::PosNormalColorVertex* verts{ plane.get_verts() };
+	const worldWp::util::PlaneSpecs& ms{ plane.get_specs() };
+	auto height{ [&](int x, int z) { return verts[x*ms.z_dim + z].pos[1]; } };
+	for(int x{0}; x != ms.x_dim; ++x)
+		for(int z{0}; z != ms.z_dim; ++z) {
+			int x0{ std::max(x-1, 0) }, x1{ std::min(x+1, ms.x_dim-1) },
+			    z0{ std::max(z-1, 0) }, z1{ std::min(z+1, ms.z_dim-1) };
+			bx::Vec3 normal{ bx::normalize({
+				-(height(x1, z) - height(x0, z)) / ((x1-x0)*ms.res),
+				1,
+				-(height(x, z1) - height(x, z0)) / ((z1-z0)*ms.res) }) };
+			float* out{ slot.normals + (x*ms.z_dim + z)*3 };
+			out[0] = normal.x;
+			out[1] = normal.y;
+			out[2] = normal.z;
+			slot.heights[x*ms.z_dim + z] = height(x, z);
+		}
+	publisher.end_write();
+}
+
+/**
+ * Rerun the cpu-work of a recording as fast as possible, without window.
+ * Checksums are compared against the recording, timings printed per stage.
+ * @return 0 if all checksums match.
+ */
+int replay(const worldWp::Recording& rec) {
+	specs = rec.config.specs;
+
+	FastNoise fn;
+	fn.SetNoiseType(FastNoise::Perlin);
+	fn.SetSeed(rec.seeds[0]);
+	worldWp::Plane plane(specs, fn, make_noise_mods(rec.config), 0xffcccccc, 0,
+	                     rec.config.tile_octaves);
+	worldWp::Transition transition{plane, rec.config.tran_length};
+	transition.set_erosion(rec.config.erosion_iterations);
+
+	//accumulated time of each stage in ms.
+	double t_noise{0}, t_morph{0}, t_normals{0}, t_checksum{0};
+	auto timed{ [](double& acc, const std::function<void()>& stage) {
+		auto start{ std::chrono::steady_clock::now() };
+		stage();
+		acc += std::chrono::duration<double, std::milli>(
+			std::chrono::steady_clock::now() - start).count();
+	}};
+
+	size_t next_seed{1};
+	int mismatches{0};
+	uint64_t checksum;
+	for(size_t f{0}; f != rec.frames.size(); ++f) {
+		transition.next_frame();
+		if (transition.starting() && next_seed != rec.seeds.size())
+			timed(t_noise, [&]() {
+				fn.SetSeed(rec.seeds[next_seed++]);
+				transition.set_target(fn);
+			});
+		timed(t_morph, [&]() { transition.step(); });
+		timed(t_normals, [&]() { plane.add_normals(); });
+		timed(t_checksum, [&]() { checksum = plane_checksum(plane); });
+
+		if (checksum != rec.frames[f].checksum && mismatches++ == 0)
+			fprintf(stderr, "First checksum mismatch in frame %zu\n", f);
+	}
+
+	double frames( std::max<size_t>(rec.frames.size(), 1) );
+	printf("frames:     %zu\n", rec.frames.size());
+	printf("mismatches: %d\n", mismatches);
+	printf("stage       total[ms]  per frame[ms]\n");
+	printf("noise    %12.3f %14.5f\n", t_noise, t_noise/frames);
+	printf("morph    %12.3f %14.5f\n", t_morph, t_morph/frames);
+	printf("normals  %12.3f %14.5f\n", t_normals, t_normals/frames);
+	printf("checksum %12.3f %14.5f\n", t_checksum, t_checksum/frames);
+	return mismatches == 0 ? 0 : 1;
+}
+
+/**
+ * Render the first terrain of a run on the cpu into path (png or ppm),
+ * without window or gpu.
+ */
+int preview(const worldWp::Recording& rec, const char* path) {
+	specs = rec.config.specs;
+
+	FastNoise fn;
+	fn.SetNoiseType(FastNoise::Perlin);
+	fn.SetSeed(rec.seeds[0]);
+	worldWp::Plane plane(specs, fn, make_noise_mods(rec.config), 0xffcccccc, 0,
+	                     rec.config.tile_octaves);
+	//erodes plane like in the window.
+	worldWp::Transition transition{plane, rec.config.tran_length};
+	transition.set_erosion(rec.config.erosion_iterations);
+	worldWp::Frame frame {specs, 0xff444444, -40.02, 90};
+
+	//same view as the window, without rotation.
+	int width{1000}, height{1000};
+	float view[16], proj[16], mtx[16];
+	bx::mtxLookAt(view, {0, 25*2, 100*2}, {0, 0, 0});
+	bx::mtxProj(proj, 60.0f, float(width)/height, 0.1f, 800.0f, false);
+	bx::mtxRotateXY(mtx, 0, 0);
+
+	worldWp::SoftRenderer renderer{width, height};
+	renderer.set_view_transform(view, proj);
+	auto start{ std::chrono::steady_clock::now() };
+	renderer.clear(0xffffffff);
+	renderer.draw(frame, mtx, worldWp::SoftRenderer::SIMPLE);
+	renderer.draw(plane, mtx, worldWp::SoftRenderer::LINES);
+	printf("rendered %zu triangles in %.3f ms\n", renderer.get_triangle_count(),
+		std::chrono::duration<double, std::milli>(
+			std::chrono::steady_clock::now() - start).count());
+
+	if (!renderer.write(path)) {
+		fprintf(stderr, "Could not write preview to %s\n", path);
+		return 1;
+	}
+	return 0;
+}
 
 /**
  * Create new GLFW-Window with dims width x height. GLFW needs to be initialized.
@@ -75,14 +227,133 @@ std::ostream& operator<<(std::ostream& out, const bx::Vec3& v) {
 	return out << "{" << v.x << ", " << v.y << ", " << v.z << "}";
 }
 
+/**
+ * Time sorting count random draws and show how many draws merging static
+ * models saves. Needs no window, nothing is submitted.
+ */
+int bench_queue(int count) {
+	using clock = std::chrono::steady_clock;
+	worldWp::RenderQueue queue;
+	uint16_t transforms[4];
+	for(uint16_t& t : transforms)
+		t = queue.add_transform();
+
+	//frames with 4 transforms and 2 programs, merged into 8 draws.
+	std::vector<std::unique_ptr<worldWp::Frame>> frames;
+	for(int i{0}; i != 256; ++i) {
+		frames.emplace_back(new worldWp::Frame{specs, 0xff444444, float(i), 90});
+		queue.add_static(0, {uint16_t(i/4%2)}, *frames.back(), transforms[i%4]);
+	}
+	int static_before{ queue.get_static_count() };
+	auto start{ clock::now() };
+	queue.build_static();
+	double t_merge{ std::chrono::duration<double, std::milli>(clock::now()-start).count() };
+	printf("static draws: %d -> %d (merged in %.3f ms)\n",
+		static_before, queue.get_static_count(), t_merge);
+
+	std::mt19937 rng{0};
+	std::uniform_int_distribution<uint16_t> program{0, 63};
+	std::uniform_real_distribution<float> depth{0, 800};
+	const uint64_t states[] {BGFX_STATE_DEFAULT, BGFX_STATE_DEFAULT | BGFX_STATE_PT_LINES};
+	int runs{10};
+	double t_sort{0};
+	for(int r{0}; r != runs; ++r) {
+		queue.clear();
+		for(int i{0}; i != count; ++i)
+			queue.add(rng()%4, {program(rng)}, *frames[i%frames.size()],
+				transforms[i%4], states[rng()%2], depth(rng));
+		start = clock::now();
+		queue.sort();
+		t_sort += std::chrono::duration<double, std::milli>(clock::now()-start).count();
+	}
+	printf("sorted %d draws in %.3f ms (%.1f M draws/s)\n",
+		count, t_sort/runs, count/(t_sort/runs)/1000);
+	return 0;
+}
+
 int main(int argc, char** argv) {
 	//using so lines dont get too long.
 	using namespace bgfx;
-	
+
+	//--record <file>: save config, seeds and input of this run.
+	//--replay <file>: rerun a recording headless, see replay.
+	//--budget <MiB>: release idle models over this, print usage on exit.
+	//--bench-queue <draws>: benchmark RenderQueue headless.
+	//--erosion <iterations>: erode each new terrain.
+	//--noise-tiles <octaves>: sample cached noise-tiles instead of FastNoise.
+	//--preview <file>: render the first terrain to png/ppm without window.
+	//--publish <name>: publish heights to shared memory, see heightbench.
+	const char *record_path{nullptr},
+	           *preview_path{nullptr},
+	           *publish_name{nullptr};
+	size_t budget{0};
+	int erosion_iterations{0},
+	    tile_octaves{0};
+	for(int i{1}; i+1 < argc; ++i) {
+		if (std::strcmp(argv[i], "--record") == 0)
+			record_path = argv[++i];
+		else if (std::strcmp(argv[i], "--budget") == 0)
+			budget = std::strtoul(argv[++i], nullptr, 10)*1024*1024;
+		else if (std::strcmp(argv[i], "--erosion") == 0) {
+			erosion_iterations = std::atoi(argv[++i]);
+			if (erosion_iterations < 0) {
+				fprintf(stderr, "--erosion needs 0 or more iterations\n");
+				return 1;
+			}
+		}
+		else if (std::strcmp(argv[i], "--noise-tiles") == 0) {
+			tile_octaves = std::atoi(argv[++i]);
+			if (tile_octaves < 0 || tile_octaves > worldWp::NoiseTiles::max_octaves) {
+				fprintf(stderr, "--noise-tiles needs 0 to %d octaves\n", worldWp::NoiseTiles::max_octaves);
+				return 1;
+			}
+		}
+		else if (std::strcmp(argv[i], "--preview") == 0)
+			preview_path = argv[++i];
+		else if (std::strcmp(argv[i], "--publish") == 0)
+			publish_name = argv[++i];
+		else if (std::strcmp(argv[i], "--bench-queue") == 0)
+			return bench_queue(std::atoi(argv[i+1]));
+		else if (std::strcmp(argv[i], "--replay") == 0) {
+			worldWp::Recording rec;
+			if (!rec.read(argv[i+1]))
+				return 1;
+			return replay(rec);
+		}
+	}
+
+	worldWp::ResourceManager& resources{ worldWp::ResourceManager::get() };
+	resources.set_budget(budget);
+	//only report changes, the overshoot usually stays the same for many frames.
+	resources.set_over_budget_report([last_over = size_t{0}](size_t over) mutable {
+		if (over != last_over)
+			fprintf(stderr, "Models in use exceed memory budget by %zu bytes\n", over);
+		last_over = over;
+	});
+
+	worldWp::Recording rec;
+	rec.config = {specs, 2, 2, 0, 0, 800, erosion_iterations, tile_octaves};
+	rec.seeds.push_back(std::rand());
+	if (preview_path)
+		return preview(rec, preview_path);
+
+	//map shaders while the terrain is generated.
+	worldWp::ShaderCache shader_cache{"build/shaders/"};
+	shader_cache.preload_archive("build/shaders/shaders.pak");
+
 	FastNoise fn;
 	fn.SetNoiseType(FastNoise::Perlin);
-	fn.SetSeed(std::rand());
-	worldWp::Plane plane(specs, fn, {2, 2, specs, edge_smooth_mod, no_mod}, 0xffcccccc, 0);
+	fn.SetSeed(rec.seeds[0]);
+	worldWp::Plane plane(specs, fn, make_noise_mods(rec.config), 0xffcccccc, 0,
+	                     rec.config.tile_octaves);
+	worldWp::Transition transition{plane, rec.config.tran_length};
+	transition.set_erosion(rec.config.erosion_iterations);
+
+	//heights for other processes, written whenever the morph advances.
+	std::unique_ptr<worldWp::HeightPublisher> publisher;
+	if (publish_name)
+		publisher.reset(new worldWp::HeightPublisher{
+			publish_name, specs.x_dim, specs.z_dim, float(specs.res)});
 	
 	worldWp::Frame frame {specs, 0xff444444, -40.02, 90};
 	glfwInit();
@@ -97,47 +368,32 @@ int main(int argc, char** argv) {
 	const ViewId clearView = 0;
 	setViewClear(clearView, BGFX_CLEAR_COLOR | BGFX_CLEAR_DEPTH, 0xffffffff, 1.0f, 0);
 	
-	VertexBufferHandle vbh = plane.getVBufferHandle();
-	//VertexBufferHandle vbh = createVertexBuffer(
-	//    makeRef(cubeVertices, sizeof(cubeVertices)),
-	//    worldWp::PosNormalColorVertex::layout);
-	
-	IndexBufferHandle ibh = plane.getIBufferHandle();
-	//IndexBufferHandle ibh = createIndexBuffer(
-	//	makeRef(cubeTriList, sizeof(cubeTriList)));
+	ProgramHandle program_simple {shader_cache.get_program("vs_simple", "fs_simple")};
+	ProgramHandle program_lines {shader_cache.get_program("vs_lines", "fs_lines")};
 
-	VertexBufferHandle frame_vbh{frame.getVBufferHandle()};
-	IndexBufferHandle frame_ibh{frame.getIBufferHandle()};
-
-	ShaderHandle vsh = worldWp::util::load_shader("build/shaders/vs_simple.bin");
-	ShaderHandle fsh = worldWp::util::load_shader("build/shaders/fs_simple.bin");
-	ProgramHandle program_simple = createProgram(vsh, fsh, true);
-
-	vsh = worldWp::util::load_shader("build/shaders/vs_lines.bin");
-	fsh = worldWp::util::load_shader("build/shaders/fs_lines.bin");
-	ProgramHandle program_lines {createProgram(vsh, fsh, true)};
+	worldWp::RenderQueue queue;
+	uint16_t model_mtx{ queue.add_transform() };
+	queue.add_static(clearView, program_simple, frame, model_mtx);
+	queue.build_static();
 
 	touch(clearView);
 
 	float pos {-15.0f};
 
-	int frame_ctr{-1}, ctr{0};
-
-	int tran_length{800};
-	float *offset_noise;
+	int ctr{0};
 
 	//For tracking mouse cursor while holding lmb.
 	double mouse_pos_last[2];
 	double mouse_pos_current[2];
-	double mouse_offset[2];
+	double mouse_offset[2] {0, 0};
 
 	//left mouse button.
 	bool lmb_pressed {false};
 	while (!glfwWindowShouldClose(window)) {
-		++frame_ctr;
-		if (frame_ctr == tran_length)
-			frame_ctr = 0;
-		
+		transition.next_frame();
+		//buffers may be released here if over budget.
+		resources.next_frame();
+
 		glfwPollEvents();
 		int oldWidth = width, oldHeight = height;
 		glfwGetWindowSize(window, &width, &height);
@@ -165,27 +421,22 @@ int main(int argc, char** argv) {
 			lmb_pressed = false;
 		}
 
-		if (frame_ctr == 0) {
-			fn.SetSeed(std::rand());
-			float* new_noise = plane.get_raw_noise(fn);
-
-			offset_noise = new float[specs.x_dim*specs.z_dim];
-			plane.for_each_vertex(
-				[new_noise, offset_noise, tran_length]
-				(worldWp::util::PosNormalColorVertex& v, int i) {
-					//offset_nose is difference between new and old noise.
-					offset_noise[i] = (new_noise[i] - v.pos[1])*(1.0/tran_length);
-			});
+		if (transition.starting()) {
+			rec.seeds.push_back(std::rand());
+			fn.SetSeed(rec.seeds.back());
+			transition.set_target(fn);
 		}
 
-		plane.for_each_vertex(
-			[offset_noise](worldWp::util::PosNormalColorVertex& v, int i) {
-				v.pos[1]+=offset_noise[i];
-		});
+		transition.step();
 		plane.add_normals();
+		if (publisher && publisher->is_open())
+			publish_heights(*publisher, plane);
+		if (record_path)
+			rec.frames.push_back({
+				{float(mouse_offset[0]), float(mouse_offset[1])},
+				plane_checksum(plane) });
 		//IMPORTANT!!!
-		bgfx::destroy(vbh);
-		vbh = plane.getVBufferHandle();
+		plane.invalidateVBuffer();
 
 		bx::Vec3 at  {0, 0, 0};
 		bx::Vec3 eye {0, 25*2, 100*2};
@@ -213,25 +464,22 @@ int main(int argc, char** argv) {
 		//bx::mtxRotateY(mtx, bx::kPiQuarter*(pos+=.01));
 		//bx::mtxRotateY(mtx, bx::kPiQuarter);
 
-		//submit plane+base.
-		bgfx::setTransform(mtx);
-		bgfx::setVertexBuffer(0, vbh);
-		bgfx::setIndexBuffer(ibh);
-		bgfx::submit(clearView, program_lines);
-
-		//submit Frame.
-		bgfx::setState(BGFX_STATE_DEFAULT | frame.get_indzs_state());
-		bgfx::setTransform(mtx);
-		bgfx::setVertexBuffer(0, frame_vbh);
-		bgfx::setIndexBuffer(frame_ibh);
-		bgfx::submit(clearView, program_simple);
+		//submit plane+base, Frame is static.
+		queue.set_transform(model_mtx, mtx);
+		queue.add(clearView, program_lines, plane, model_mtx);
+		queue.submit();
 
 		bgfx::frame();
 	}
 
-	delete offset_noise;
-	destroy(vbh);
-	destroy(ibh);
+	if (record_path && !rec.write(record_path))
+		fprintf(stderr, "Could not write recording to %s\n", record_path);
+
+	if (budget != 0)
+		resources.print_usage(stdout);
+
+	resources.release_gpu();
+	shader_cache.destroy();
 	shutdown();
 	glfwTerminate();
 	return 0;
@@ -0,0 +1,90 @@
+#include "Contours.hpp"
+
+#include "FastNoise.h"
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+using namespace worldWp;
+
+const util::PlaneSpecs ms{90, 70, 1};
+const float interval{5};
+//lines are lifted this much above their level, see Contours.cpp.
+const float line_offset{.05};
+
+std::vector<util::PosNormalColorVertex> copy_verts(const Contours& contours) {
+	return { contours.get_verts(), contours.get_verts() + contours.get_vert_sz() };
+}
+
+//every vertex lies on a level and within the grid.
+bool check_levels(const char* name, const Contours& contours) {
+	float half_x( (ms.x_dim-1)*ms.res/2.0f ),
+	      half_z( (ms.z_dim-1)*ms.res/2.0f );
+	int errors{0};
+	for(int i{0}; i != contours.get_vert_sz(); ++i) {
+		const float* pos{ contours.get_verts()[i].pos };
+		float level{ (pos[1] - line_offset)/interval };
+		if (std::fabs(level - std::round(level)) < 1e-4f
+		 && std::fabs(pos[0]) <= half_x + 1e-4f && std::fabs(pos[2]) <= half_z + 1e-4f)
+			continue;
+		if (errors++ < 5)
+			printf("vertex %d at (%g, %g, %g) is off a level or the grid\n", i, pos[0], pos[1], pos[2]);
+	}
+	bool ok{ errors == 0 && contours.get_segment_count() > 0
+	      && contours.get_vert_sz() == 2*contours.get_segment_count() };
+	printf("%s %s: %d segments, %d bands updated\n", ok ? "ok  " : "FAIL",
+		name, contours.get_segment_count(), contours.get_updated_band_count());
+	return ok;
+}
+
+bool same(const std::vector<util::PosNormalColorVertex>& a,
+  const std::vector<util::PosNormalColorVertex>& b) {
+	if (a.size() != b.size())
+		return false;
+	for(size_t i{0}; i != a.size(); ++i)
+		for(int k{0}; k != 3; ++k)
+			if (a[i].pos[k] != b[i].pos[k])
+				return false;
+	return true;
+}
+
+int main() {
+	FastNoise fn;
+	fn.SetSeed(3);
+	std::vector<float> heights(ms.x_dim*ms.z_dim);
+	for(int x{0}; x != ms.x_dim; ++x)
+		for(int z{0}; z != ms.z_dim; ++z)
+			heights[x*ms.z_dim + z] = fn.GetNoise(x*8, z*8)*40;
+
+	Contours contours{ms, interval, 0xff000000};
+	contours.update(heights.data());
+	int band_count{ contours.get_updated_band_count() };
+	bool ok{ check_levels("initial", contours) };
+	std::vector<util::PosNormalColorVertex> initial{ copy_verts(contours) };
+
+	contours.update(heights.data());
+	if (contours.get_updated_band_count() != 0 || !same(initial, copy_verts(contours))) {
+		printf("FAIL unchanged heights: %d bands updated\n", contours.get_updated_band_count());
+		ok = false;
+	}
+
+	//a bump inside the third band, rows 32..47.
+	for(int x{36}; x != 42; ++x)
+		for(int z{20}; z != 30; ++z)
+			heights[x*ms.z_dim + z] += 12;
+	contours.update(heights.data());
+	ok = check_levels("bump", contours) && ok;
+	if (contours.get_updated_band_count() != 1) {
+		printf("FAIL bump: %d of %d bands updated, expected 1\n",
+			contours.get_updated_band_count(), band_count);
+		ok = false;
+	}
+	//reused bands have to match a full extraction.
+	Contours fresh{ms, interval, 0xff000000};
+	fresh.update(heights.data());
+	if (!same(copy_verts(fresh), copy_verts(contours))) {
+		printf("FAIL bump: lines differ from a full extraction\n");
+		ok = false;
+	}
+	return ok ? 0 : 1;
+}
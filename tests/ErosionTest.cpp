@@ -0,0 +1,41 @@
+#include "Erosion.hpp"
+
+#include "FastNoise.h"
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+using namespace worldWp;
+
+const util::PlaneSpecs ms{200, 150, 1};
+
+std::vector<float> erode(const std::vector<float>& heights, int thread_count) {
+	util::set_thread_count(thread_count);
+	Erosion erosion{ms, heights.data(), {}, 50};
+	//uneven budgets, like spreading the iterations over frames.
+	while (!erosion.step(7));
+	return erosion.get_heights();
+}
+
+int main() {
+	FastNoise fn;
+	fn.SetSeed(3);
+	std::vector<float> heights(ms.x_dim*ms.z_dim);
+	for(int x{0}; x != ms.x_dim; ++x)
+		for(int z{0}; z != ms.z_dim; ++z)
+			heights[x*ms.z_dim + z] = fn.GetNoise(x*4, z*4)*40;
+
+	std::vector<float> serial{ erode(heights, 1) };
+	bool ok{ std::memcmp(serial.data(), heights.data(), heights.size()*sizeof(float)) != 0 };
+	if (!ok)
+		printf("FAIL erosion didn't change the heights\n");
+	for(int thread_count : {2, 3, 4, 8}) {
+		std::vector<float> parallel{ erode(heights, thread_count) };
+		bool same{ std::memcmp(serial.data(), parallel.data(), serial.size()*sizeof(float)) == 0 };
+		printf("%s %d threads vs 1 thread: %s\n", same ? "ok  " : "FAIL",
+			thread_count, same ? "identical" : "different");
+		ok = same && ok;
+	}
+	util::set_thread_count(0);
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,151 @@
+#include "HeightQuadtree.hpp"
+
+#include "FastNoise.h"
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <random>
+#include <vector>
+
+using namespace worldWp;
+using Ray = HeightQuadtree::Ray;
+using Hit = HeightQuadtree::Hit;
+
+const util::PlaneSpecs ms{129, 97, 2};
+
+bx::Vec3 vert(const std::vector<float>& heights, int x, int z) {
+	return { x*ms.res - (ms.x_dim-1)*ms.res/2.0f, heights[x*ms.z_dim + z],
+	         z*ms.res - (ms.z_dim-1)*ms.res/2.0f };
+}
+
+//Möller-Trumbore, t < 0 on a miss.
+float intersect(const Ray& ray, bx::Vec3 a, bx::Vec3 b, bx::Vec3 c) {
+	bx::Vec3 e1{ bx::sub(b, a) },
+	         e2{ bx::sub(c, a) },
+	         p{ bx::cross(ray.dir, e2) };
+	float det{ bx::dot(e1, p) };
+	if (std::fabs(det) < 1e-12f)
+		return -1;
+	bx::Vec3 s{ bx::sub(ray.origin, a) },
+	         q{ bx::cross(s, e1) };
+	float u{ bx::dot(s, p)/det },
+	      v{ bx::dot(ray.dir, q)/det };
+	if (u < 0 || u > 1 || v < 0 || u+v > 1)
+		return -1;
+	return bx::dot(e2, q)/det;
+}
+
+//nearest hit over both triangles of every quad.
+float brute_raycast(const std::vector<float>& heights, const Ray& ray) {
+	float best{ std::numeric_limits<float>::infinity() };
+	for(int x{0}; x != ms.x_dim-1; ++x)
+		for(int z{0}; z != ms.z_dim-1; ++z) {
+			bx::Vec3 v1{ vert(heights, x, z) },
+			         v2{ vert(heights, x, z+1) },
+			         v3{ vert(heights, x+1, z) },
+			         v4{ vert(heights, x+1, z+1) };
+			for(float t : {intersect(ray, v1, v2, v3), intersect(ray, v2, v4, v3)})
+				if (t >= 0 && t < best)
+					best = t;
+		}
+	return best;
+}
+
+//bilinear height of the cell found by walking the grid.
+float brute_height_at(const std::vector<float>& heights, float x, float z) {
+	int i{0}, j{0};
+	while (i < ms.x_dim-2 && vert(heights, i+1, 0).x <= x)
+		++i;
+	while (j < ms.z_dim-2 && vert(heights, 0, j+1).z <= z)
+		++j;
+	bx::Vec3 v{ vert(heights, i, j) };
+	float fx{ bx::clamp((x - v.x)/ms.res, 0.0f, 1.0f) },
+	      fz{ bx::clamp((z - v.z)/ms.res, 0.0f, 1.0f) };
+	return bx::lerp(bx::lerp(heights[i*ms.z_dim + j], heights[i*ms.z_dim + j+1], fz),
+	                bx::lerp(heights[(i+1)*ms.z_dim + j], heights[(i+1)*ms.z_dim + j+1], fz), fx);
+}
+
+/**
+ * Compare single and batched raycasts and height_at of tree against the
+ * brute force versions on heights.
+ */
+bool check(const char* name, const HeightQuadtree& tree, const std::vector<float>& heights,
+  const std::vector<Ray>& rays, const std::vector<bx::Vec3>& points) {
+	std::vector<Hit> batched(rays.size());
+	tree.raycast(rays.data(), batched.data(), rays.size());
+
+	int hits{0}, ray_errors{0}, height_errors{0};
+	for(size_t r{0}; r != rays.size(); ++r) {
+		float t{ brute_raycast(heights, rays[r]) };
+		bool hit{ t != std::numeric_limits<float>::infinity() };
+		Hit single{ tree.raycast(rays[r]) };
+		hits += hit;
+		for(const Hit& h : {single, batched[r]}) {
+			if (h.hit == hit && (!hit || std::fabs(h.t - t) <= 1e-3f*std::max(1.0f, t)))
+				continue;
+			if (ray_errors++ < 5)
+				printf("ray %zu: hit %d t %g, expected hit %d t %g\n", r, h.hit, h.t, hit, t);
+		}
+	}
+	for(const bx::Vec3& p : points) {
+		float h{ tree.height_at(p.x, p.z) },
+		      expected{ brute_height_at(heights, p.x, p.z) };
+		if (std::fabs(h - expected) > 1e-3f && height_errors++ < 5)
+			printf("height_at(%g, %g) = %g, expected %g\n", p.x, p.z, h, expected);
+	}
+
+	bool ok{ ray_errors == 0 && height_errors == 0 };
+	printf("%s %s: %d of %zu rays hit, %d ray and %d height mismatches\n",
+		ok ? "ok  " : "FAIL", name, hits, rays.size(), ray_errors, height_errors);
+	return ok;
+}
+
+int main() {
+	FastNoise fn;
+	fn.SetSeed(3);
+	std::vector<float> heights(ms.x_dim*ms.z_dim);
+	for(int x{0}; x != ms.x_dim; ++x)
+		for(int z{0}; z != ms.z_dim; ++z)
+			heights[x*ms.z_dim + z] = fn.GetNoise(x*8, z*8)*60;
+
+	std::mt19937 rng{1};
+	std::uniform_real_distribution<float> uniform{-1, 1};
+	float half_x( (ms.x_dim-1)*ms.res/2.0f ),
+	      half_z( (ms.z_dim-1)*ms.res/2.0f );
+	std::vector<Ray> rays(1000);
+	for(Ray& ray : rays) {
+		//from above, some starting beside the grid and some missing it.
+		ray.origin = { uniform(rng)*half_x*1.5f, 100 + uniform(rng)*50, uniform(rng)*half_z*1.5f };
+		ray.dir = bx::normalize(bx::Vec3{ uniform(rng), -1 + .5f*uniform(rng), uniform(rng) });
+	}
+	//grid vertices, cell centers, random points and points beside the grid.
+	std::vector<bx::Vec3> points;
+	for(int x{0}; x < ms.x_dim; x += 7)
+		for(int z{0}; z < ms.z_dim; z += 5) {
+			bx::Vec3 v{ vert(heights, x, z) };
+			points.push_back(v);
+			points.push_back({ v.x + ms.res/2.0f, 0, v.z + ms.res/2.0f });
+		}
+	for(int i{0}; i != 500; ++i)
+		points.push_back({ uniform(rng)*half_x*1.2f, 0, uniform(rng)*half_z*1.2f });
+
+	HeightQuadtree tree{ms, heights.data()};
+	bool ok{ check("initial", tree, heights, rays, points) };
+
+	//raise a block at the border and dig a pit inside, then update only them.
+	for(int x{0}; x != 20; ++x)
+		for(int z{80}; z != ms.z_dim; ++z)
+			heights[x*ms.z_dim + z] += 150;
+	for(int x{60}; x != 75; ++x)
+		for(int z{30}; z != 41; ++z)
+			heights[x*ms.z_dim + z] -= 200;
+	tree.update(heights.data(), 0, 80, 20, ms.z_dim);
+	tree.update(heights.data(), 60, 30, 75, 41);
+	ok = check("partial update", tree, heights, rays, points) && ok;
+
+	for(float& h : heights)
+		h = -h*.5f;
+	tree.update(heights.data());
+	ok = check("full update", tree, heights, rays, points) && ok;
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,61 @@
+#include "Plane.hpp"
+
+#include "FastNoise.h"
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+using namespace worldWp;
+
+std::vector<util::PosNormalColorVertex> copy_verts(Plane& plane) {
+	std::vector<util::PosNormalColorVertex> verts;
+	plane.for_each_vertex([&](util::PosNormalColorVertex& v, int) {
+		verts.push_back(v);
+	});
+	return verts;
+}
+
+int main() {
+	const util::PlaneSpecs ms{120, 90, 1};
+	FastNoise fn;
+	fn.SetSeed(3);
+	util::NoiseMods nm{2, 2, ms, [](int, int) { return 60.0f; }, [](float n) { return n; }};
+	Plane plane{ms, fn, nm, 0xffcccccc, 0};
+	bool ok{true};
+	if (plane.is_dynamic()) {
+		printf("new plane already uses its dynamic vertex buffer\n");
+		ok = false;
+	}
+
+	//inside, at a corner and overlapping the far border.
+	plane.apply_brush({util::Brush::RAISE, 10}, 10, 20, 30, 25);
+	plane.apply_brush({util::Brush::SMOOTH, 1}, 0, 0, 5, 5);
+	plane.apply_brush({util::Brush::LOWER, 3}, ms.x_dim-4, ms.z_dim-3, ms.x_dim+5, ms.z_dim+5);
+	if (!plane.is_dynamic()) {
+		printf("brushed plane doesn't use its dynamic vertex buffer\n");
+		ok = false;
+	}
+	std::vector<util::PosNormalColorVertex> brushed{ copy_verts(plane) };
+
+	plane.add_normals();
+	std::vector<util::PosNormalColorVertex> full{ copy_verts(plane) };
+
+	float max_diff{0};
+	int mismatches{0};
+	for(size_t i{0}; i != brushed.size(); ++i)
+		for(int k{0}; k != 3; ++k) {
+			float diff{ std::fmax(std::fabs(brushed[i].pos[k] - full[i].pos[k]),
+			                      std::fabs(brushed[i].normal[k] - full[i].normal[k])) };
+			//unused normals may be nan in both.
+			if (std::isnan(brushed[i].normal[k]) != std::isnan(full[i].normal[k]))
+				diff = INFINITY;
+			if (!(diff <= 1e-5f) && !std::isnan(diff) && mismatches++ < 5)
+				printf("vertex %zu differs by %g\n", i, diff);
+			if (!std::isnan(diff))
+				max_diff = std::fmax(max_diff, diff);
+		}
+	ok = ok && mismatches == 0;
+	printf("%s brush vs full recompute: %zu vertices, max difference %g\n",
+		ok ? "ok  " : "FAIL", brushed.size(), max_diff);
+	return ok ? 0 : 1;
+}
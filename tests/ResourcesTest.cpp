@@ -0,0 +1,46 @@
+#include "Frame.hpp"
+#include "Resources.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+using namespace worldWp;
+
+int main() {
+	const util::PlaneSpecs ms{90, 90, 1};
+	ResourceManager& resources{ ResourceManager::get() };
+	Frame frame{ms, 0xff444444, -40.02, 90};
+	std::vector<util::PosNormalColorVertex> verts;
+	std::vector<uint32_t> indzs;
+	frame.append_to(verts, indzs);
+	bgfx::VertexBufferHandle vbh{ frame.getVBufferHandle() };
+	bool ok{true};
+
+	//in use, so only the cpu-arrays can go.
+	resources.set_budget(1);
+	resources.next_frame();
+	if (frame.get_cpu_bytes() != 0 || frame.get_verts() != nullptr) {
+		printf("FAIL frame kept %zu cpu bytes over budget\n", frame.get_cpu_bytes());
+		ok = false;
+	}
+	if (frame.getVBufferHandle().idx != vbh.idx || frame.get_gpu_bytes() == 0) {
+		printf("FAIL frame lost its buffers with its cpu-arrays\n");
+		ok = false;
+	}
+
+	//creating buffers again regenerates the same vertices.
+	frame.release_gpu();
+	resources.set_budget(0);
+	frame.getVBufferHandle();
+	std::vector<util::PosNormalColorVertex> rebuilt_verts;
+	std::vector<uint32_t> rebuilt_indzs;
+	frame.append_to(rebuilt_verts, rebuilt_indzs);
+	if (frame.get_cpu_bytes() == 0 || rebuilt_indzs != indzs || rebuilt_verts.size() != verts.size()
+	 || std::memcmp(rebuilt_verts.data(), verts.data(), verts.size()*sizeof(verts[0])) != 0) {
+		printf("FAIL rebuilt frame differs\n");
+		ok = false;
+	}
+	printf("%s frame released and rebuilt, %zu vertices\n", ok ? "ok  " : "FAIL", verts.size());
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,96 @@
+#include "Rtin.hpp"
+#include "AdaptivePlane.hpp"
+
+#include "FastNoise.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+using namespace worldWp;
+
+std::vector<float> make_heights(const util::PlaneSpecs& ms) {
+	FastNoise fn;
+	fn.SetSeed(3);
+	std::vector<float> heights(ms.x_dim*ms.z_dim);
+	for(int x{0}; x != ms.x_dim; ++x)
+		for(int z{0}; z != ms.z_dim; ++z) {
+			//noise on a smooth hill, plus a sharp ridge the error metric has to catch.
+			float hill{ std::sin(float(x)/(ms.x_dim-1)*3.14159f)
+			          * std::sin(float(z)/(ms.z_dim-1)*3.14159f)*60 };
+			heights[x*ms.z_dim + z] = hill + fn.GetNoise(x*4, z*4)*20
+			                        + (x == ms.x_dim/3 ? 15 : 0);
+		}
+	return heights;
+}
+
+/**
+ * Interpolate every triangle of Rtin::triangles at all grid points it covers,
+ * check the deviation against max_error and that the triangles tile the grid
+ * exactly once.
+ */
+bool check(const util::PlaneSpecs& ms, float max_error) {
+	std::vector<float> heights{ make_heights(ms) };
+	Rtin rtin{ms, heights.data()};
+	std::vector<uint32_t> tris{ rtin.triangles(max_error) };
+
+	std::vector<int> covered(ms.x_dim*ms.z_dim, 0);
+	double area{0};
+	float max_dev{0};
+	bool ok{true};
+	for(size_t t{0}; t < tris.size(); t += 3) {
+		int ax( tris[t]/ms.z_dim ),   az( tris[t]%ms.z_dim ),
+		    bx( tris[t+1]/ms.z_dim ), bz( tris[t+1]%ms.z_dim ),
+		    cx( tris[t+2]/ms.z_dim ), cz( tris[t+2]%ms.z_dim );
+		double d( (bx-ax)*(cz-az) - (cx-ax)*(bz-az) );
+		if (d == 0 || std::max({ax, bx, cx}) >= ms.x_dim || std::max({az, bz, cz}) >= ms.z_dim) {
+			printf("triangle %zu is degenerate or out of the grid\n", t/3);
+			return false;
+		}
+		area += std::fabs(d)/2;
+
+		for(int x{ std::min({ax, bx, cx}) }; x <= std::max({ax, bx, cx}); ++x)
+			for(int z{ std::min({az, bz, cz}) }; z <= std::max({az, bz, cz}); ++z) {
+				double l1{ ((bx-x)*(cz-z) - (cx-x)*(bz-z))/d },
+				       l2{ ((cx-x)*(az-z) - (ax-x)*(cz-z))/d },
+				       l3{ 1 - l1 - l2 };
+				if (l1 < -1e-9 || l2 < -1e-9 || l3 < -1e-9)
+					continue;
+				covered[x*ms.z_dim + z] = 1;
+				float h( l1*heights[tris[t]] + l2*heights[tris[t+1]] + l3*heights[tris[t+2]] );
+				max_dev = std::max(max_dev, std::fabs(h - heights[x*ms.z_dim + z]));
+			}
+	}
+
+	int uncovered( std::count(covered.begin(), covered.end(), 0) );
+	double expected_area( double(ms.x_dim-1)*(ms.z_dim-1) );
+	//small slack for float interpolation.
+	if (max_dev > max_error + 1e-3f) {
+		printf("max deviation %g above max_error %g\n", max_dev, max_error);
+		ok = false;
+	}
+	if (uncovered != 0 || std::fabs(area - expected_area) > 1e-6) {
+		printf("%d grid points uncovered, area %g instead of %g\n", uncovered, area, expected_area);
+		ok = false;
+	}
+
+	AdaptivePlane adaptive{ms, heights.data(), max_error, 0xffcccccc};
+	if (size_t(adaptive.get_triangle_count()) != tris.size()/3) {
+		printf("AdaptivePlane has %d triangles, Rtin %zu\n", adaptive.get_triangle_count(), tris.size()/3);
+		ok = false;
+	}
+	printf("%s %dx%d max_error %g: %zu triangles, max deviation %g, reduction %.2fx\n",
+		ok ? "ok  " : "FAIL", ms.x_dim, ms.z_dim, max_error, tris.size()/3,
+		max_dev, adaptive.get_reduction());
+	return ok;
+}
+
+int main() {
+	const util::PlaneSpecs sizes[] { {129, 129, 1}, {90, 90, 1}, {200, 57, 1} };
+	const float errors[] {0, .5, 4};
+	bool ok{true};
+	for(const util::PlaneSpecs& ms : sizes)
+		for(float max_error : errors)
+			ok = check(ms, max_error) && ok;
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,75 @@
+#include "TiledPlane.hpp"
+#include "Plane.hpp"
+
+#include "FastNoise.h"
+#include <cmath>
+#include <cstdio>
+
+using namespace worldWp;
+
+bool same(const float* a, const float* b) {
+	for(int k{0}; k != 3; ++k)
+		if (std::fabs(a[k] - b[k]) > 1e-5f)
+			return false;
+	return true;
+}
+
+/**
+ * Every tile index has to stay within its tile and refer to the same grid
+ * vertex as the index at the same place of an untiled Plane, with the same
+ * position. Provoking (last) vertices need the same normal.
+ */
+bool check(const util::PlaneSpecs& ms, int tile_octaves) {
+	FastNoise fn;
+	fn.SetSeed(3);
+	util::NoiseMods nm{2, 2, ms, [](int, int) { return 60.0f; }, [](float n) { return n; }};
+	Plane plane{ms, fn, nm, 0xffcccccc, 0, tile_octaves};
+	TiledPlane tiled{ms, fn, nm, 0xffcccccc, tile_octaves};
+
+	int grid_sz{ ms.x_dim*ms.z_dim },
+	    errors{0};
+	for(const TiledPlane::Tile& t : tiled.get_tiles()) {
+		const util::PosNormalColorVertex* verts{ tiled.get_verts() + t.vert_start };
+		const uint16_t* indzs{ tiled.get_indzs() + t.indx_start };
+		//indices of the quads of a grid-row.
+		int row_indzs{ (ms.z_dim-1)*12 },
+		    tile_sz{ t.rows*ms.z_dim };
+		const uint32_t* plane_indzs{ plane.get_indzs() + t.row_start*row_indzs };
+
+		for(uint32_t i{0}; i != t.indx_sz; ++i) {
+			if (indzs[i] >= t.vert_sz) {
+				if (errors++ < 5)
+					printf("index %u of tile at row %d is %u, tile has %u vertices\n",
+						i, t.row_start, indzs[i], t.vert_sz);
+				continue;
+			}
+			//copy and grid-index of the tile vertex in the untiled grid.
+			uint32_t copy( indzs[i]/tile_sz ),
+			         grid_indx( t.row_start*ms.z_dim + indzs[i]%tile_sz ),
+			         plane_indx( copy*grid_sz + grid_indx );
+			const util::PosNormalColorVertex &v{ verts[indzs[i]] },
+			                                 &pv{ plane.get_verts()[plane_indx] };
+			bool provoking{ i%3 == 2 };
+			if (plane_indx != plane_indzs[i] || !same(v.pos, pv.pos)
+			 || (provoking && !same(v.normal, pv.normal))) {
+				if (errors++ < 5)
+					printf("index %u of tile at row %d differs from the plane\n", i, t.row_start);
+			}
+		}
+	}
+
+	bool ok{ errors == 0 };
+	printf("%s %dx%d tile_octaves %d: %zu tiles\n", ok ? "ok  " : "FAIL",
+		ms.x_dim, ms.z_dim, tile_octaves, tiled.get_tiles().size());
+	return ok;
+}
+
+int main() {
+	bool ok{true};
+	//one tile, several tiles, and several tiles with a short last one.
+	const util::PlaneSpecs sizes[] { {90, 90, 1}, {300, 200, 1}, {400, 257, 2} };
+	for(const util::PlaneSpecs& ms : sizes)
+		for(int tile_octaves : {0, 2})
+			ok = check(ms, tile_octaves) && ok;
+	return ok ? 0 : 1;
+}